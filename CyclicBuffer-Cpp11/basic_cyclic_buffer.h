@@ -0,0 +1,638 @@
+#ifndef _BASIC_CYCLIC_BUFFER_H_
+#define _BASIC_CYCLIC_BUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <stddef.h>
+#include <assert.h>
+
+#include "spin_lock.h"
+#include "watermark.h"
+
+namespace cyclic_policy
+{
+	// Concurrency: which side(s) may be used from more than one thread at a time.
+
+	struct spsc { static constexpr bool multi_producer{ false }; static constexpr bool multi_consumer{ false }; };
+	struct mpsc { static constexpr bool multi_producer{ true }; static constexpr bool multi_consumer{ false }; };
+	struct spmc { static constexpr bool multi_producer{ false }; static constexpr bool multi_consumer{ true }; };
+	struct mpmc { static constexpr bool multi_producer{ true }; static constexpr bool multi_consumer{ true }; };
+
+	// Overflow: what push does when the buffer is full.
+
+	struct overwrite_oldest { };	// evict the oldest element, push always succeeds
+	struct drop_newest { };			// reject the new element and count it in 'get_dropped'
+	struct block { };				// wait for space
+	struct fail { };				// reject the new element
+
+	// Wait: how a blocking call waits for data (or space, under 'block').
+
+	class spin_wait
+	{
+	public:
+		spin_wait() = default;
+		spin_wait(const spin_wait&) = delete;
+		spin_wait& operator=(const spin_wait&) = delete;
+
+		inline void notify() { }
+
+		template<class _Pred>
+		inline void wait(_Pred && pred) const
+		{
+			while (!pred())
+				std::this_thread::yield();
+		}
+
+		template<class _Pred, class _Clock, class _Duration>
+		inline bool wait_until(_Pred && pred, const std::chrono::time_point<_Clock, _Duration>& timeout_time) const
+		{
+			while (!pred())
+			{
+				if (_Clock::now() >= timeout_time)
+					return pred();
+
+				std::this_thread::yield();
+			}
+
+			return true;
+		}
+	};
+
+	class park_wait
+	{
+	private:
+		// how often a parked thread re-checks on its own, bounding a wake-up lost to 'notify'
+		// racing with it parking
+		enum { recheck_ms = 1 };
+
+		std::atomic<std::size_t> waiters{ 0 };
+		mutable spin_lock guard;
+		mutable std::condition_variable_any cv;
+
+	public:
+		park_wait() = default;
+		park_wait(const park_wait&) = delete;
+		park_wait& operator=(const park_wait&) = delete;
+
+		// costs a single load unless somebody is parked
+		inline void notify()
+		{
+			if (waiters.load(std::memory_order_relaxed) == 0)
+				return;
+
+			std::lock_guard<spin_lock> lock(guard);
+			cv.notify_all();
+		}
+
+		template<class _Pred>
+		inline void wait(_Pred && pred)
+		{
+			if (pred())
+				return;
+
+			std::unique_lock<spin_lock> lock(guard);
+			waiters.fetch_add(1);
+
+			while (!pred())
+				cv.wait_for(lock, std::chrono::milliseconds(recheck_ms));
+
+			waiters.fetch_sub(1);
+		}
+
+		template<class _Pred, class _Clock, class _Duration>
+		inline bool wait_until(_Pred && pred, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+		{
+			if (pred())
+				return true;
+
+			std::unique_lock<spin_lock> lock(guard);
+			waiters.fetch_add(1);
+
+			bool result{ true };
+			while (!pred())
+			{
+				typename _Clock::time_point const now{ _Clock::now() };
+				if (now >= timeout_time)
+				{
+					result = pred();
+					break;
+				}
+
+				if (timeout_time - now < std::chrono::milliseconds(recheck_ms))
+					cv.wait_until(lock, timeout_time);
+				else
+					cv.wait_for(lock, std::chrono::milliseconds(recheck_ms));
+			}
+
+			waiters.fetch_sub(1);
+
+			return result;
+		}
+	};
+
+	// Storage: where the cells live.
+
+	struct heap_storage
+	{
+		template<class _Cell>
+		class holder
+		{
+		private:
+			_Cell * const cells;
+			const std::size_t capacity;
+			const std::size_t mask;
+
+		public:
+			holder(const holder&) = delete;
+			holder& operator=(const holder&) = delete;
+
+			holder(const std::size_t & _capacity) :
+				cells{ new _Cell[_capacity] },
+				capacity{ _capacity },
+				mask{ (_capacity & (_capacity - 1)) == 0 ? _capacity - 1 : 0 }
+			{ }
+
+			~holder()
+			{
+				delete[] cells;
+			}
+
+			inline std::size_t get_capacity() const
+			{
+				return capacity;
+			}
+
+			inline _Cell & operator[](const std::size_t & position) const
+			{
+				return cells[mask != 0 ? (position & mask) : (position % capacity)];
+			}
+		};
+	};
+
+	template<std::size_t _Capacity>
+	struct static_storage
+	{
+		template<class _Cell>
+		class holder
+		{
+		private:
+			mutable _Cell cells[_Capacity];
+
+		public:
+			holder(const holder&) = delete;
+			holder& operator=(const holder&) = delete;
+
+			holder(const std::size_t & _capacity = _Capacity)
+			{
+				assert(_capacity == _Capacity /* Error: 'static_storage' capacity is fixed at compile time. */);
+			}
+
+			inline constexpr std::size_t get_capacity() const
+			{
+				return _Capacity;
+			}
+
+			inline _Cell & operator[](const std::size_t & position) const
+			{
+				return cells[position % _Capacity];
+			}
+		};
+	};
+}
+
+// Bounded lock-free ring (per-cell sequence numbers) whose behavior is assembled from
+// orthogonal policies; unlike 'cyclic_buffer<_Ty, _LockFree, _Recyclable>', every overflow
+// behavior is available with every concurrency mode.
+template<typename _Ty,
+	class _Concurrency = cyclic_policy::spsc,
+	class _Overflow = cyclic_policy::block,
+	class _Wait = cyclic_policy::park_wait,
+	class _Storage = cyclic_policy::heap_storage>
+class basic_cyclic_buffer
+{
+	static_assert(!std::is_const<_Ty>::value, "Error: 'basic_cyclic_buffer' type can not be const.");
+	static_assert(!std::is_volatile<_Ty>::value, "Error: 'basic_cyclic_buffer' type can not be volatile.");
+	static_assert(!std::is_reference<_Ty>::value, "Error: 'basic_cyclic_buffer' type can not be reference.");
+
+public:
+	typedef _Ty value_type;
+	typedef basic_cyclic_buffer<_Ty, _Concurrency, _Overflow, _Wait, _Storage> type;
+	typedef _Concurrency concurrency_policy;
+	typedef _Overflow overflow_policy;
+	typedef _Wait wait_policy;
+	typedef _Storage storage_policy;
+
+	static constexpr bool is_lock_free{ true };
+	static constexpr bool is_recyclable{ false };
+	static constexpr bool is_overwriting{ std::is_same<_Overflow, cyclic_policy::overwrite_oldest>::value };
+	static constexpr bool is_blocking{ std::is_same<_Overflow, cyclic_policy::block>::value };
+	static constexpr bool is_dropping{ std::is_same<_Overflow, cyclic_policy::drop_newest>::value };
+
+private:
+	// an overwriting producer evicts from the consumer side, so the read cursor is shared then
+	typedef std::integral_constant<bool, _Concurrency::multi_producer> shared_write;
+	typedef std::integral_constant<bool, _Concurrency::multi_consumer || is_overwriting> shared_read;
+	// nobody ever waits for space in an overwriting buffer
+	typedef std::integral_constant<bool, !is_overwriting> notify_space;
+
+	struct cell
+	{
+		std::atomic<std::size_t> sequence;
+		value_type value;
+	};
+
+	enum { cache_line = 64 };
+
+	typename _Storage::template holder<cell> cells;
+	const std::size_t capacity;
+
+	char pad_0[cache_line];
+	std::atomic<std::size_t> write_position;
+	char pad_1[cache_line - sizeof(std::atomic<std::size_t>)];
+	std::atomic<std::size_t> read_position;
+	char pad_2[cache_line - sizeof(std::atomic<std::size_t>)];
+
+	std::atomic<std::size_t> dropped;
+	std::atomic<bool> terminated;
+
+	mutable _Wait data_waiter;
+	mutable _Wait space_waiter;
+
+	watermark levels;
+
+public:
+	basic_cyclic_buffer(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	basic_cyclic_buffer(const std::size_t & _capacity) :
+		cells{ _capacity },
+		capacity{ _capacity }
+	{
+		assert(_capacity > (std::size_t)1);
+
+		for (std::size_t i = 0; i < capacity; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+
+		write_position.store(0, std::memory_order_relaxed);
+		read_position.store(0, std::memory_order_relaxed);
+		dropped = 0;
+		terminated = false;
+	}
+
+	~basic_cyclic_buffer()
+	{
+		if (!terminated)
+			terminate();
+	}
+
+	inline void terminate()
+	{
+		terminated = true;
+		data_waiter.notify();
+		space_waiter.notify();
+	}
+
+	inline bool is_terminated() const
+	{
+		return terminated;
+	}
+
+	// true when the element was stored; under 'block' waits for space (false once terminated)
+	inline bool push(const value_type & value)
+	{
+		return push_(value, _Overflow{});
+	}
+
+	inline bool try_push(const value_type & value)
+	{
+		if (enqueue_(value))
+			return true;
+
+		return try_push_full_(value, _Overflow{});
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_push_for(const value_type & value, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return try_push_until(value, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_push_until(const value_type & value, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (!enqueue_(value))
+		{
+			if (is_overwriting)
+				return push(value);
+
+			if (terminated || !wait_for_space_until(timeout_time))
+			{
+				if (is_dropping)
+					dropped.fetch_add(1, std::memory_order_relaxed);
+
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// waits for data; false once the buffer is terminated and drained
+	inline bool pop(value_type & value)
+	{
+		while (!dequeue_(value))
+		{
+			if (terminated)
+				return dequeue_(value);
+
+			wait_for_data();
+		}
+
+		return true;
+	}
+
+	inline bool try_pop(value_type & value)
+	{
+		return dequeue_(value);
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_pop_for(value_type & value, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return try_pop_until(value, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_pop_until(value_type & value, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (!dequeue_(value))
+		{
+			if (terminated || !wait_for_data_until(timeout_time))
+				return dequeue_(value);
+		}
+
+		return true;
+	}
+
+	inline std::size_t push_range(const value_type * values, const std::size_t & count)
+	{
+		std::size_t pushed{ 0 };
+		while ((pushed < count) && push(values[pushed]))
+			++pushed;
+
+		return pushed;
+	}
+
+	template<class _Func>
+	inline std::size_t consume_all(_Func && _func)
+	{
+		return this->consume_up_to((std::size_t)-1, std::forward<_Func>(_func));
+	}
+
+	template<class _Func>
+	inline std::size_t consume_up_to(const std::size_t & _count, _Func && _func)
+	{
+		std::size_t count{ 0 };
+		while ((count < _count) && consume_(_func))
+			++count;
+
+		if (count > 0)
+			notify_space_(notify_space{});
+
+		return count;
+	}
+
+	inline void wait_for_data() const
+	{
+		data_waiter.wait([this] { return !empty_() || terminated; });
+	}
+
+	template<class _Rep, class _Period>
+	inline bool wait_for_data_for(const std::chrono::duration<_Rep, _Period>& rel_time) const
+	{
+		return wait_for_data_until(std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool wait_for_data_until(const std::chrono::time_point<_Clock, _Duration>& timeout_time) const
+	{
+		return data_waiter.wait_until([this] { return !empty_() || terminated; }, timeout_time);
+	}
+
+	inline void wait_for_space() const
+	{
+		space_waiter.wait([this] { return !full_() || terminated; });
+	}
+
+	template<class _Rep, class _Period>
+	inline bool wait_for_space_for(const std::chrono::duration<_Rep, _Period>& rel_time) const
+	{
+		return wait_for_space_until(std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool wait_for_space_until(const std::chrono::time_point<_Clock, _Duration>& timeout_time) const
+	{
+		return space_waiter.wait_until([this] { return !full_() || terminated; }, timeout_time);
+	}
+
+	inline std::size_t get_capacity() const
+	{
+		return capacity;
+	}
+
+	inline std::size_t get_size() const
+	{
+		std::size_t const read{ read_position.load(std::memory_order_relaxed) };
+		std::size_t const write{ write_position.load(std::memory_order_relaxed) };
+
+		return (write > read ? write - read : 0);
+	}
+
+	inline std::size_t get_dropped() const
+	{
+		return dropped.load(std::memory_order_relaxed);
+	}
+
+	// not thread safe; configure before the buffer is shared
+	inline void set_watermarks(const std::size_t & high, const std::size_t & low, watermark::callback_type callback = nullptr)
+	{
+		levels.set(high, low, std::move(callback));
+	}
+
+	inline bool is_high_watermark() const
+	{
+		return levels.is_high();
+	}
+
+private:
+	inline bool empty_() const
+	{
+		std::size_t const position{ read_position.load(std::memory_order_relaxed) };
+
+		return (cells[position].sequence.load(std::memory_order_acquire) != position + 1);
+	}
+
+	inline bool full_() const
+	{
+		std::size_t const position{ write_position.load(std::memory_order_relaxed) };
+
+		return (cells[position].sequence.load(std::memory_order_acquire) != position);
+	}
+
+	static inline bool claim_(std::atomic<std::size_t> & cursor, std::size_t & position, std::true_type)
+	{
+		return cursor.compare_exchange_weak(position, position + 1, std::memory_order_relaxed);
+	}
+
+	static inline bool claim_(std::atomic<std::size_t> & cursor, std::size_t & position, std::false_type)
+	{
+		cursor.store(position + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	inline bool enqueue_(const value_type & value)
+	{
+		std::size_t position{ write_position.load(std::memory_order_relaxed) };
+		cell * target;
+
+		for (;;)
+		{
+			target = &cells[position];
+			std::ptrdiff_t const diff{ (std::ptrdiff_t)target->sequence.load(std::memory_order_acquire) - (std::ptrdiff_t)position };
+
+			if (diff == 0)
+			{
+				if (claim_(write_position, position, shared_write{}))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				position = write_position.load(std::memory_order_relaxed);
+		}
+
+		target->value = value;
+		target->sequence.store(position + 1, std::memory_order_release);
+
+		data_waiter.notify();
+
+		if (levels.is_enabled())
+			levels.on_add(get_size(), [this] { return get_size(); });
+
+		return true;
+	}
+
+	template<class _Func>
+	inline bool consume_(_Func & _func)
+	{
+		std::size_t position{ read_position.load(std::memory_order_relaxed) };
+		cell * target;
+
+		for (;;)
+		{
+			target = &cells[position];
+			std::ptrdiff_t const diff{ (std::ptrdiff_t)target->sequence.load(std::memory_order_acquire) - (std::ptrdiff_t)(position + 1) };
+
+			if (diff == 0)
+			{
+				if (claim_(read_position, position, shared_read{}))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				position = read_position.load(std::memory_order_relaxed);
+		}
+
+		_func(target->value);
+		target->sequence.store(position + capacity, std::memory_order_release);
+
+		if (levels.is_enabled())
+			levels.on_sub(get_size(), [this] { return get_size(); });
+
+		return true;
+	}
+
+	inline bool dequeue_(value_type & value)
+	{
+		auto take = [&value](value_type & item) { value = std::move(item); };
+		if (!consume_(take))
+			return false;
+
+		notify_space_(notify_space{});
+
+		return true;
+	}
+
+	inline void notify_space_(std::true_type)
+	{
+		space_waiter.notify();
+	}
+
+	inline void notify_space_(std::false_type) { }
+
+	inline bool push_(const value_type & value, cyclic_policy::overwrite_oldest)
+	{
+		auto discard = [](value_type &) { };
+		while (!enqueue_(value))
+			consume_(discard);
+
+		return true;
+	}
+
+	inline bool push_(const value_type & value, cyclic_policy::drop_newest)
+	{
+		if (enqueue_(value))
+			return true;
+
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	inline bool push_(const value_type & value, cyclic_policy::block)
+	{
+		while (!enqueue_(value))
+		{
+			if (terminated)
+				return false;
+
+			wait_for_space();
+		}
+
+		return true;
+	}
+
+	inline bool push_(const value_type & value, cyclic_policy::fail)
+	{
+		return enqueue_(value);
+	}
+
+	inline bool try_push_full_(const value_type & value, cyclic_policy::overwrite_oldest)
+	{
+		return push_(value, cyclic_policy::overwrite_oldest{});
+	}
+
+	inline bool try_push_full_(const value_type &, cyclic_policy::drop_newest)
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	inline bool try_push_full_(const value_type &, cyclic_policy::block)
+	{
+		return false;
+	}
+
+	inline bool try_push_full_(const value_type &, cyclic_policy::fail)
+	{
+		return false;
+	}
+};
+
+#endif // !_BASIC_CYCLIC_BUFFER_H_
@@ -0,0 +1,168 @@
+#ifndef _BIT_OPS_H_
+#define _BIT_OPS_H_
+
+#include <cstddef>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Word-at-a-time helpers over bitmaps stored as arrays of uint64_t, bit i living in
+// word i / 64 at position i % 64. Ranges are linear; callers split wrapped ones.
+namespace bit_ops
+{
+	static constexpr std::size_t word_bits{ 64 };
+
+	inline std::size_t word_count(const std::size_t bits)
+	{
+		return (bits + word_bits - 1) / word_bits;
+	}
+
+	// 'value' must not be 0
+	inline unsigned count_trailing_zeros(const uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long result;
+#ifdef _WIN64
+		_BitScanForward64(&result, value);
+#else
+		if (!_BitScanForward(&result, (unsigned long)value))
+		{
+			_BitScanForward(&result, (unsigned long)(value >> 32));
+			result += 32;
+		}
+#endif
+		return (unsigned)result;
+#else
+		return (unsigned)__builtin_ctzll(value);
+#endif
+	}
+
+	inline unsigned count_trailing_ones(const uint64_t value)
+	{
+		return (~value == 0 ? (unsigned)word_bits : count_trailing_zeros(~value));
+	}
+
+	inline unsigned popcount(uint64_t value)
+	{
+#if defined(_MSC_VER) || !defined(__GNUC__)
+		unsigned result{ 0 };
+		for (/* nothing */; value != 0; value &= value - 1)
+			++result;
+
+		return result;
+#else
+		return (unsigned)__builtin_popcountll(value);
+#endif
+	}
+
+	// 'count' ones starting at bit 'first'; 'count' must be below 64
+	inline uint64_t mask(const unsigned first, const unsigned count)
+	{
+		return (((uint64_t)1 << count) - 1) << first;
+	}
+
+	inline bool test(const uint64_t * words, const std::size_t bit)
+	{
+		return ((words[bit / word_bits] >> (bit % word_bits)) & 1) != 0;
+	}
+
+	inline void set(uint64_t * words, const std::size_t bit)
+	{
+		words[bit / word_bits] |= (uint64_t)1 << (bit % word_bits);
+	}
+
+	inline void reset(uint64_t * words, const std::size_t bit)
+	{
+		words[bit / word_bits] &= ~((uint64_t)1 << (bit % word_bits));
+	}
+
+	// clears bits [first, first + count)
+	inline void clear_range(uint64_t * words, std::size_t first, std::size_t count)
+	{
+		while (count > 0)
+		{
+			unsigned const shift{ (unsigned)(first % word_bits) };
+			if ((shift == 0) && (count >= word_bits))
+			{
+				std::size_t const whole{ count / word_bits };
+				memset(words + first / word_bits, 0, whole * sizeof(uint64_t));
+
+				first += whole * word_bits;
+				count -= whole * word_bits;
+				continue;
+			}
+
+			unsigned const chunk{ (unsigned)(count < word_bits - shift ? count : word_bits - shift) };
+			words[first / word_bits] &= ~(chunk == word_bits ? ~(uint64_t)0 : mask(shift, chunk));
+
+			first += chunk;
+			count -= chunk;
+		}
+	}
+
+	// length of the run of set bits starting at 'first', at most 'limit'
+	inline std::size_t count_ones(const uint64_t * words, const std::size_t first, const std::size_t limit)
+	{
+		std::size_t result{ 0 };
+
+		while (result < limit)
+		{
+			std::size_t const bit{ first + result };
+			unsigned const shift{ (unsigned)(bit % word_bits) };
+			unsigned const run{ count_trailing_ones(words[bit / word_bits] >> shift) };
+			unsigned const available{ (unsigned)word_bits - shift };
+
+			result += (run < available ? run : available);
+			if (run < available)
+				break;
+		}
+
+		return (result < limit ? result : limit);
+	}
+
+	// length of the run of clear bits starting at 'first', at most 'limit'
+	inline std::size_t count_zeros(const uint64_t * words, const std::size_t first, const std::size_t limit)
+	{
+		std::size_t result{ 0 };
+
+		while (result < limit)
+		{
+			std::size_t const bit{ first + result };
+			unsigned const shift{ (unsigned)(bit % word_bits) };
+			uint64_t const word{ words[bit / word_bits] >> shift };
+			unsigned const available{ (unsigned)word_bits - shift };
+			unsigned const run{ word == 0 ? available : count_trailing_zeros(word) };
+
+			result += run;
+			if (run < available)
+				break;
+		}
+
+		return (result < limit ? result : limit);
+	}
+
+	// number of set bits in [first, first + count)
+	inline std::size_t count_set(const uint64_t * words, std::size_t first, std::size_t count)
+	{
+		std::size_t result{ 0 };
+
+		while (count > 0)
+		{
+			unsigned const shift{ (unsigned)(first % word_bits) };
+			unsigned const chunk{ (unsigned)(count < word_bits - shift ? count : word_bits - shift) };
+			uint64_t const word{ words[first / word_bits] >> shift };
+
+			result += popcount(chunk == word_bits ? word : word & mask(0, chunk));
+
+			first += chunk;
+			count -= chunk;
+		}
+
+		return result;
+	}
+}
+
+#endif // !_BIT_OPS_H_
@@ -0,0 +1,267 @@
+#ifndef _CONCURRENT_REASSEMBLER_H_
+#define _CONCURRENT_REASSEMBLER_H_
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "basic_cyclic_buffer.h"
+
+// Multi producer / single consumer reassembler. Producers fill distinct slots without a
+// lock, each slot moving empty -> writing -> ready; the consumer drains the ready run at
+// the window start, also without a lock. A producer whose index lies beyond the window
+// parks until the consumer has advanced far enough. Indices must be unique within one
+// 'modulus' turn, as with 'cyclic_reassembler'. A value lives in its slot only while the
+// slot is ready: it is copy-constructed there by the producer and destroyed once consumed.
+template<typename _Ty, class _Wait = cyclic_policy::park_wait>
+class concurrent_reassembler
+{
+	static_assert(!std::is_const<_Ty>::value, "Error: 'concurrent_reassembler' type can not be const.");
+	static_assert(!std::is_volatile<_Ty>::value, "Error: 'concurrent_reassembler' type can not be volatile.");
+	static_assert(!std::is_reference<_Ty>::value, "Error: 'concurrent_reassembler' type can not be reference.");
+
+public:
+	typedef _Ty value_type;
+	typedef concurrent_reassembler<_Ty, _Wait> type;
+
+private:
+	enum : uint8_t
+	{
+		slot_empty,
+		slot_writing,
+		slot_ready
+	};
+
+	enum { cache_line = 64 };
+
+	const std::size_t modulus_;
+	const std::size_t size_;
+
+	value_type * const data_;
+	std::atomic<uint8_t> * const states_;
+
+	char pad_0[cache_line];
+	std::atomic<std::size_t> position_; // elements delivered so far, written by the consumer only
+	char pad_1[cache_line - sizeof(std::atomic<std::size_t>)];
+
+	std::atomic<bool> terminated;
+	mutable _Wait data_waiter;
+	mutable _Wait window_waiter;
+
+public:
+	concurrent_reassembler(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	concurrent_reassembler(const std::size_t & _modulus, const std::size_t & _size) :
+		modulus_{ _modulus },
+		size_{ _size },
+		data_{ (value_type*)malloc(_size * sizeof(value_type)) },
+		states_{ new std::atomic<uint8_t>[_size] }
+	{
+		assert(_modulus > (std::size_t)1 /* Error: 'concurrent_reassembler' modulus must be greater than 1. */);
+		assert(_size > (std::size_t)1 /* Error: 'concurrent_reassembler' size must be greater than 1. */);
+		assert(_modulus >= _size /* Error: 'concurrent_reassembler' modulus must be greater than or equal to its size. */);
+
+		for (std::size_t i = 0; i < size_; ++i)
+			states_[i].store(slot_empty, std::memory_order_relaxed);
+
+		position_.store(0, std::memory_order_relaxed);
+		terminated = false;
+	}
+
+	concurrent_reassembler(const std::size_t & _modulus) :
+		concurrent_reassembler{ _modulus, _modulus }
+	{ }
+
+	~concurrent_reassembler()
+	{
+		if (!terminated)
+			terminate();
+
+		for (std::size_t i = 0; i < size_; ++i)
+		{
+			if (states_[i].load(std::memory_order_relaxed) == slot_ready)
+				data_[i].~value_type();
+		}
+
+		free(data_);
+		delete[] states_;
+	}
+
+	inline void terminate()
+	{
+		terminated = true;
+		data_waiter.notify();
+		window_waiter.notify();
+	}
+
+	inline bool is_terminated() const
+	{
+		return terminated;
+	}
+
+	inline std::size_t modulus() const
+	{
+		return modulus_;
+	}
+
+	inline std::size_t size() const
+	{
+		return size_;
+	}
+
+	inline std::size_t offset() const
+	{
+		return position_.load(std::memory_order_acquire) % modulus_;
+	}
+
+	inline bool valid_index(const std::size_t & _index) const
+	{
+		return (distance_(_index, position_.load(std::memory_order_acquire)) < size_);
+	}
+
+	// false when '_index' is beyond the window or was already pushed
+	inline bool try_push(const value_type & _value, const std::size_t & _index)
+	{
+		assert(_index < modulus_);
+
+		std::size_t const position{ position_.load(std::memory_order_acquire) };
+		std::size_t const distance{ distance_(_index, position) };
+		if (distance >= size_)
+			return false;
+
+		return fill_((position + distance) % size_, _value);
+	}
+
+	// parks while '_index' is beyond the window; false when it was already pushed or
+	// the reassembler is terminated
+	inline bool push(const value_type & _value, const std::size_t & _index)
+	{
+		assert(_index < modulus_);
+
+		for (;;)
+		{
+			std::size_t const position{ position_.load(std::memory_order_acquire) };
+			std::size_t const distance{ distance_(_index, position) };
+
+			if (distance < size_)
+				return fill_((position + distance) % size_, _value);
+
+			if (terminated)
+				return false;
+
+			window_waiter.wait([this, &_index] { return valid_index(_index) || terminated; });
+		}
+	}
+
+	inline bool try_pop(value_type & _value)
+	{
+		return (consume_ready(1, [&_value](value_type & it) { _value = std::move(it); }) == 1);
+	}
+
+	// waits for the next in-order element; false once terminated and it has not arrived
+	inline bool pop(value_type & _value)
+	{
+		while (!try_pop(_value))
+		{
+			if (terminated)
+				return try_pop(_value);
+
+			wait_for_data();
+		}
+
+		return true;
+	}
+
+	// hands up to '_count' in-order ready elements to '_func', then advances the window
+	// once and wakes parked producers once; each element is destroyed after '_func'
+	template<class _Func>
+	inline std::size_t consume_ready(const std::size_t & _count, _Func && _func)
+	{
+		std::size_t const start{ position_.load(std::memory_order_relaxed) };
+		std::size_t count{ 0 };
+
+		for (std::size_t slot = start % size_; count < _count; (slot == size_ - 1 ? slot = 0 : ++slot))
+		{
+			if (states_[slot].load(std::memory_order_acquire) != slot_ready)
+				break;
+
+			_func(data_[slot]);
+			data_[slot].~value_type();
+			states_[slot].store(slot_empty, std::memory_order_release);
+			++count;
+		}
+
+		if (count > 0)
+		{
+			position_.store(start + count, std::memory_order_release);
+			window_waiter.notify();
+		}
+
+		return count;
+	}
+
+	// consumer side: the run of ready elements at the window start
+	inline std::size_t ready_count() const
+	{
+		std::size_t const start{ position_.load(std::memory_order_relaxed) % size_ };
+		std::size_t result{ 0 };
+
+		while ((result < size_) && (states_[(start + result) % size_].load(std::memory_order_acquire) == slot_ready))
+			++result;
+
+		return result;
+	}
+
+	inline void wait_for_data() const
+	{
+		data_waiter.wait([this] { return head_ready_() || terminated; });
+	}
+
+	template<class _Rep, class _Period>
+	inline bool wait_for_data_for(const std::chrono::duration<_Rep, _Period>& rel_time) const
+	{
+		return wait_for_data_until(std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool wait_for_data_until(const std::chrono::time_point<_Clock, _Duration>& timeout_time) const
+	{
+		return data_waiter.wait_until([this] { return head_ready_() || terminated; }, timeout_time);
+	}
+
+private:
+	inline std::size_t distance_(const std::size_t & _index, const std::size_t & position) const
+	{
+		std::size_t const base{ position % modulus_ };
+
+		return (_index >= base ? _index - base : _index + (modulus_ - base));
+	}
+
+	inline bool fill_(const std::size_t & slot, const value_type & _value)
+	{
+		uint8_t expected{ slot_empty };
+		if (!states_[slot].compare_exchange_strong(expected, slot_writing, std::memory_order_acquire, std::memory_order_relaxed))
+			return false;
+
+		new (data_ + slot) value_type(_value);
+		states_[slot].store(slot_ready, std::memory_order_release);
+
+		data_waiter.notify();
+
+		return true;
+	}
+
+	inline bool head_ready_() const
+	{
+		return (states_[position_.load(std::memory_order_relaxed) % size_].load(std::memory_order_acquire) == slot_ready);
+	}
+};
+
+#endif // !_CONCURRENT_REASSEMBLER_H_
@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <assert.h>
 
 #include "spin_lock.h"
 
@@ -16,6 +17,7 @@ protected:
 
 	mutable std::condition_variable_any cv;
 	mutable spin_lock guard;
+	mutable std::size_t wake_value;
 	bool terminated;
 
 public:
@@ -27,6 +29,7 @@ public:
 		add_lock = (_initial_value == _max_value);
 		sub_lock = (_initial_value == 0);
 		value = _initial_value;
+		wake_value = 0;
 		terminated = false;
 	}
 
@@ -48,14 +51,15 @@ public:
 		return value.load();
 	}
 
-	inline void add()
+	inline std::size_t add()
 	{
 		std::unique_lock<spin_lock> lock(guard);
 
 		while (add_lock && !terminated)
 			cv.wait(lock);
 
-		if (value.fetch_add(1) == max_value - 1)
+		std::size_t const current{ value.fetch_add(1) + 1 };
+		if (current == max_value)
 			add_lock = true;
 
 		if (sub_lock)
@@ -63,16 +67,45 @@ public:
 			sub_lock = false;
 			cv.notify_all();
 		}
+		else if (current == wake_value)
+			cv.notify_all();
+
+		return current;
+	}
+
+	inline std::size_t add(const std::size_t count)
+	{
+		std::unique_lock<spin_lock> lock(guard);
+
+		while (add_lock && !terminated)
+			cv.wait(lock);
+
+		assert(value.load() + count <= max_value);
+
+		std::size_t const current{ value.fetch_add(count) + count };
+		if (current == max_value)
+			add_lock = true;
+
+		if (sub_lock)
+		{
+			sub_lock = false;
+			cv.notify_all();
+		}
+		else if ((current >= wake_value) && (current - count < wake_value))
+			cv.notify_all();
+
+		return current;
 	}
 
-	inline void sub()
+	inline std::size_t sub()
 	{
 		std::unique_lock<spin_lock> lock(guard);
 
 		while (sub_lock && !terminated)
 			cv.wait(lock);
 
-		if (value.fetch_sub(1) == 1)
+		std::size_t const current{ value.fetch_sub(1) - 1 };
+		if (current == 0)
 			sub_lock = true;
 
 		if (add_lock)
@@ -80,6 +113,30 @@ public:
 			add_lock = false;
 			cv.notify_all();
 		}
+
+		return current;
+	}
+
+	inline std::size_t sub(const std::size_t count)
+	{
+		std::unique_lock<spin_lock> lock(guard);
+
+		while (sub_lock && !terminated)
+			cv.wait(lock);
+
+		assert(count <= value.load());
+
+		std::size_t const current{ value.fetch_sub(count) - count };
+		if (current == 0)
+			sub_lock = true;
+
+		if (add_lock)
+		{
+			add_lock = false;
+			cv.notify_all();
+		}
+
+		return current;
 	}
 
 	inline void wait_for_add() const
@@ -112,6 +169,23 @@ public:
 		return true;
 	}
 
+	// waits until at least 'target' units are available; only one waiter at a time
+	template<class _Clock, class _Duration>
+	inline bool wait_for_value_until(const std::size_t target, const std::chrono::time_point<_Clock, _Duration>& timeout_time) const
+	{
+		std::unique_lock<spin_lock> lock(guard);
+
+		wake_value = target;
+		while ((value.load() < target) && !terminated)
+		{
+			if (cv.wait_until(lock, timeout_time) == std::cv_status::timeout)
+				break;
+		}
+		wake_value = 0;
+
+		return (value.load() >= target);
+	}
+
 	inline void wait_for_sub() const
 	{
 		std::unique_lock<spin_lock> lock(guard);
@@ -1,12 +1,19 @@
 #ifndef _CYCLIC_BUFFER_H_
 #define _CYCLIC_BUFFER_H_
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <utility>
 #include <assert.h>
+#include <string.h>
 
 #include "resettable_event.h"
 #include "counter_lock.h"
+#include "cyclic_iterator.h"
+#include "cyclic_span.h"
 #include "spin_lock.h"
+#include "watermark.h"
 
 template<typename _Ty, bool _LockFree = false, bool _Recyclable = false>
 class cyclic_buffer;
@@ -24,6 +31,8 @@ public:
 	static constexpr bool is_lock_free{ true };
 	static constexpr bool is_recyclable{ true };
 
+	friend struct cyclic_snapshot_access;
+
 private:
 	value_type * const data;
 	value_type * const last_point;
@@ -32,11 +41,18 @@ private:
 
 	std::atomic<std::size_t> size;
 	const std::size_t capacity;
-	spin_lock guard;
+	mutable spin_lock guard;
 
 	manual_reset_event read_enable;
+	auto_reset_event batch_ready;
+	std::atomic<std::size_t> batch_target;
+	auto_reset_event space_ready;
+	std::atomic<bool> space_wanted;
+	std::atomic<std::size_t> dropped;
 	bool terminated;
 
+	watermark levels;
+
 public:
 	cyclic_buffer(const type &) = delete;
 	type & operator=(const type &) = delete;
@@ -53,6 +69,9 @@ public:
 
 		terminated = false;
 		read_enable.reset();
+		batch_target = 0;
+		space_wanted = false;
+		dropped = 0;
 	}
 
 	~cyclic_buffer()
@@ -67,6 +86,8 @@ public:
 	{
 		terminated = true;
 		read_enable.set();
+		batch_ready.set();
+		space_ready.set();
 	}
 
 	inline bool is_terminated() const
@@ -111,16 +132,44 @@ public:
 		if (!read_enable.is_set() && (size.load() > 0))
 			read_enable.set();
 
+		if ((batch_target.load() > 0) && (size.load() >= batch_target.load()))
+			batch_ready.set();
+
+		if (levels.is_enabled())
+			levels.on_add(size.load(), [this] { return size.load(); });
+
 		return result;
 	}
 
 	inline bool try_push(const value_type & value, value_type & result)
 	{
-		if ((write_point == last_point ? data : write_point + 1) == read_point.load())
+		if ((write_point == last_point ? data : write_point + 1) == read_point)
 		{
 			if (!read_enable.is_set() && (size.load() > 0))
 				read_enable.set();
 
+			dropped.fetch_add(1);
+			return false;
+		}
+
+		result = this->push(value);
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_push_for(const value_type & value, value_type & result, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_push_until(value, result, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_push_until(const value_type & value, value_type & result, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		// a terminated buffer stops waiting, and like the lockable ones fails rather than overwrite
+		if (!this->wait_for_space_until(timeout_time) || (terminated && this->is_full_()))
+		{
+			dropped.fetch_add(1);
 			return false;
 		}
 
@@ -139,12 +188,120 @@ public:
 		(read_point == last_point ? read_point = data : ++read_point);
 		guard.unlock();
 
-		if ((size.fetch_sub(1) == 1) && !terminated)
+		if (space_wanted.load())
+			space_ready.set();
+
+		std::size_t const current{ size.fetch_sub(1) - 1 };
+		if ((current == 0) && !terminated)
 			read_enable.reset();
 
+		levels.on_sub(current, [this] { return size.load(); });
+
 		return result;
 	}
 
+	inline bool try_pop(value_type & result, const value_type & value)
+	{
+		if (size.load() == 0)
+			return false;
+
+		result = this->pop(value);
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_pop_for(value_type & result, const value_type & value, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_pop_until(result, value, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_pop_until(value_type & result, const value_type & value, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (size.load() == 0)
+		{
+			if (terminated || !this->wait_for_data_until(timeout_time))
+				return false;
+		}
+
+		result = this->pop(value);
+
+		return true;
+	}
+
+	template<class _Func>
+	inline std::size_t consume_all(_Func && _func)
+	{
+		return this->consume_up_to((std::size_t)-1, std::forward<_Func>(_func));
+	}
+
+	template<class _Func>
+	inline std::size_t consume_up_to(const std::size_t & _count, _Func && _func)
+	{
+		guard.lock();
+
+		value_type * const start{ read_point };
+		std::size_t count{ size.load() };
+		if (_count < count)
+			count = _count;
+
+		std::size_t const first{ (std::size_t)(last_point - start) + 1 };
+		value_type * const first_end{ count < first ? start + count : last_point + 1 };
+		value_type * const second_end{ count < first ? data : data + (count - first) };
+
+		for (value_type * it = start; it != first_end; ++it)
+			_func(*it);
+
+		for (value_type * it = data; it != second_end; ++it)
+			_func(*it);
+
+		read_point = (count < first ? first_end : second_end);
+		guard.unlock();
+
+		if (space_wanted.load())
+			space_ready.set();
+
+		if (count > 0)
+		{
+			std::size_t const current{ size.fetch_sub(count) - count };
+			if ((current == 0) && !terminated)
+				read_enable.reset();
+
+			levels.on_sub(current, [this] { return size.load(); });
+		}
+
+		return count;
+	}
+
+	template<class _OutIt, class _Rep, class _Period>
+	inline std::size_t pop_batch(_OutIt _out, const value_type & value, std::size_t _max_count, const std::chrono::duration<_Rep, _Period>& max_wait, const std::size_t & _min_count = 1)
+	{
+		auto const timeout_time{ std::chrono::steady_clock::now() + max_wait };
+		if (_max_count > capacity)
+			_max_count = capacity;
+
+		if (this->wait_for_data_until(timeout_time))
+		{
+			batch_target = _max_count;
+			while ((size.load() < _max_count) && !terminated)
+			{
+				if (!batch_ready.wait_until(timeout_time))
+					break;
+			}
+			batch_target = 0;
+		}
+
+		if ((size.load() < _min_count) && !terminated)
+			return 0;
+
+		return this->consume_up_to(_max_count, [&](value_type & item) {
+			*_out = item;
+			++_out;
+			item = value;
+		});
+	}
+
 	inline const value_type operator[](const std::size_t & _index) const
 	{
 		assert(_index < get_size());
@@ -159,6 +316,43 @@ public:
 		return *(last_point - read_point < _index ? write_point - (get_size() - _index) : read_point + _index);
 	}
 
+	inline void wait_for_space()
+	{
+		while (this->is_full_() && !terminated)
+		{
+			space_wanted = true;
+			if (this->is_full_() && !terminated)
+				space_ready.wait();
+		}
+
+		space_wanted = false;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool wait_for_space_for(const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->wait_for_space_until(std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool wait_for_space_until(const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		bool result{ true };
+		while (this->is_full_() && !terminated)
+		{
+			space_wanted = true;
+			if (this->is_full_() && !terminated && !space_ready.wait_until(timeout_time))
+			{
+				result = !this->is_full_();
+				break;
+			}
+		}
+
+		space_wanted = false;
+
+		return result;
+	}
+
 	inline void wait_for_data() const
 	{
 		if (!read_enable.is_set() && !terminated)
@@ -192,6 +386,54 @@ public:
 	{
 		return size.load();
 	}
+
+	inline std::size_t get_dropped() const
+	{
+		return dropped.load();
+	}
+
+	// not thread safe; configure before the buffer is shared
+	inline void set_watermarks(const std::size_t & high, const std::size_t & low, watermark::callback_type callback = nullptr)
+	{
+		levels.set(high, low, std::move(callback));
+	}
+
+	inline bool is_high_watermark() const
+	{
+		return levels.is_high();
+	}
+
+private:
+	// 'cyclic_snapshot.h' support: the queued elements oldest first, and refilling an empty buffer
+	inline cyclic_span_pair<value_type> snapshot_segments_() const
+	{
+		value_type * const start{ read_point };
+		std::size_t const count{ get_size() };
+		std::size_t const first{ std::min(count, (std::size_t)(last_point - start) + 1) };
+
+		cyclic_span_pair<value_type> result;
+		result.first = cyclic_span<value_type>(start, first);
+		result.second = cyclic_span<value_type>(data, count - first);
+
+		return result;
+	}
+
+	inline void restore_(const value_type * records, const std::size_t & count)
+	{
+		memcpy(data, records, count * sizeof(value_type));
+		write_point = data + count;
+		size = count;
+
+		if (count > 0)
+			read_enable.set();
+	}
+
+	inline bool is_full_() const
+	{
+		std::lock_guard<spin_lock> lock(guard);
+
+		return ((write_point == last_point ? data : write_point + 1) == read_point);
+	}
 };
 
 template<typename _Ty>
@@ -207,6 +449,8 @@ public:
 	static constexpr bool is_lock_free{ true };
 	static constexpr bool is_recyclable{ false };
 
+	friend struct cyclic_snapshot_access;
+
 private:
 	value_type * const data;
 	value_type * const last_point;
@@ -217,8 +461,15 @@ private:
 	const std::size_t capacity;
 
 	manual_reset_event read_enable;
+	auto_reset_event batch_ready;
+	std::atomic<std::size_t> batch_target;
+	auto_reset_event space_ready;
+	std::atomic<bool> space_wanted;
+	std::atomic<std::size_t> dropped;
 	bool terminated;
 
+	watermark levels;
+
 public:
 	cyclic_buffer(const type &) = delete;
 	type & operator=(const type &) = delete;
@@ -235,6 +486,9 @@ public:
 
 		terminated = false;
 		read_enable.reset();
+		batch_target = 0;
+		space_wanted = false;
+		dropped = 0;
 	}
 
 	~cyclic_buffer()
@@ -249,6 +503,8 @@ public:
 	{
 		terminated = true;
 		read_enable.set();
+		batch_ready.set();
+		space_ready.set();
 	}
 
 	inline bool is_terminated() const
@@ -277,6 +533,12 @@ public:
 
 		if (!read_enable.is_set() && (size.load() > 0))
 			read_enable.set();
+
+		if ((batch_target.load() > 0) && (size.load() >= batch_target.load()))
+			batch_ready.set();
+
+		if (levels.is_enabled())
+			levels.on_add(size.load(), [this] { return size.load(); });
 	}
 
 	inline bool try_push(const value_type & value)
@@ -286,6 +548,28 @@ public:
 			if (!read_enable.is_set() && (size.load() > 0))
 				read_enable.set();
 
+			dropped.fetch_add(1);
+			return false;
+		}
+
+		this->push(value);
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_push_for(const value_type & value, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_push_until(value, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_push_until(const value_type & value, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		// a terminated buffer stops waiting, and like the lockable ones fails rather than overwrite
+		if (!this->wait_for_space_until(timeout_time) || (terminated && this->is_full_()))
+		{
+			dropped.fetch_add(1);
 			return false;
 		}
 
@@ -294,6 +578,54 @@ public:
 		return true;
 	}
 
+	inline std::size_t push_range(const value_type * values, const std::size_t & count)
+	{
+		// 'size' may still count elements a consumer is taking, so this much is free for sure;
+		// it is copied in bulk and published with one update
+		std::size_t const used{ size.load() };
+		std::size_t added{ capacity > used ? capacity - used : 0 };
+		if (count < added)
+			added = count;
+
+		std::size_t const first{ (std::size_t)(last_point - write_point) + 1 };
+		if (added < first)
+		{
+			std::copy(values, values + added, write_point);
+			write_point += added;
+		}
+		else
+		{
+			std::copy(values, values + first, write_point);
+			std::copy(values + first, values + added, data);
+			write_point = data + (added - first);
+		}
+
+		// the rest overwrites the oldest elements one by one
+		for (const value_type * it = values + added, * const stop = values + count; it != stop; ++it)
+		{
+			*write_point = *it;
+			(write_point == last_point ? write_point = data : ++write_point);
+
+			value_type * offset{ write_point };
+			if (!read_point.compare_exchange_strong(offset, offset == last_point ? data : offset + 1))
+				++added;
+		}
+
+		if (added > 0)
+			size.fetch_add(added);
+
+		if (!read_enable.is_set() && (size.load() > 0))
+			read_enable.set();
+
+		if ((batch_target.load() > 0) && (size.load() >= batch_target.load()))
+			batch_ready.set();
+
+		if (levels.is_enabled())
+			levels.on_add(size.load(), [this] { return size.load(); });
+
+		return count;
+	}
+
 	inline value_type pop()
 	{
 		this->wait_for_data();
@@ -303,12 +635,119 @@ public:
 			result = *offset;
 		} while (!read_point.compare_exchange_weak(offset, offset == last_point ? data : offset + 1));
 
-		if ((size.fetch_sub(1) == 1) && !terminated)
+		if (space_wanted.load())
+			space_ready.set();
+
+		std::size_t const current{ size.fetch_sub(1) - 1 };
+		if ((current == 0) && !terminated)
 			read_enable.reset();
 
+		levels.on_sub(current, [this] { return size.load(); });
+
 		return result;
 	}
 
+	inline bool try_pop(value_type & result)
+	{
+		if (size.load() == 0)
+			return false;
+
+		result = this->pop();
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_pop_for(value_type & result, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_pop_until(result, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_pop_until(value_type & result, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (size.load() == 0)
+		{
+			if (terminated || !this->wait_for_data_until(timeout_time))
+				return false;
+		}
+
+		result = this->pop();
+
+		return true;
+	}
+
+	template<class _Func>
+	inline std::size_t consume_all(_Func && _func)
+	{
+		return this->consume_up_to((std::size_t)-1, std::forward<_Func>(_func));
+	}
+
+	// the producer may overwrite a slot while it is read, so, as in 'pop', every element is
+	// copied out and handed over only once the read cursor is claimed past it; evictions
+	// keep 'size' unchanged, so the elements counted up front are all there to take
+	template<class _Func>
+	inline std::size_t consume_up_to(const std::size_t & _count, _Func && _func)
+	{
+		std::size_t count{ size.load() };
+		if (_count < count)
+			count = _count;
+
+		value_type * offset{ read_point.load() };
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			value_type result;
+			do {
+				result = *offset;
+			} while (!read_point.compare_exchange_weak(offset, offset == last_point ? data : offset + 1));
+
+			(offset == last_point ? offset = data : ++offset);
+			_func(result);
+		}
+
+		if (count > 0)
+		{
+			if (space_wanted.load())
+				space_ready.set();
+
+			std::size_t const current{ size.fetch_sub(count) - count };
+			if ((current == 0) && !terminated)
+				read_enable.reset();
+
+			if (levels.is_enabled())
+				levels.on_sub(current, [this] { return size.load(); });
+		}
+
+		return count;
+	}
+
+	template<class _OutIt, class _Rep, class _Period>
+	inline std::size_t pop_batch(_OutIt _out, std::size_t _max_count, const std::chrono::duration<_Rep, _Period>& max_wait, const std::size_t & _min_count = 1)
+	{
+		auto const timeout_time{ std::chrono::steady_clock::now() + max_wait };
+		if (_max_count > capacity)
+			_max_count = capacity;
+
+		if (this->wait_for_data_until(timeout_time))
+		{
+			batch_target = _max_count;
+			while ((size.load() < _max_count) && !terminated)
+			{
+				if (!batch_ready.wait_until(timeout_time))
+					break;
+			}
+			batch_target = 0;
+		}
+
+		if ((size.load() < _min_count) && !terminated)
+			return 0;
+
+		return this->consume_up_to(_max_count, [&](value_type & item) {
+			*_out = item;
+			++_out;
+		});
+	}
+
 	inline const value_type operator[](const std::size_t & _index) const
 	{
 		assert(_index < get_size());
@@ -323,6 +762,43 @@ public:
 		return *(last_point - read_point < _index ? write_point - (get_size() - _index) : read_point + _index);
 	}
 
+	inline void wait_for_space()
+	{
+		while (this->is_full_() && !terminated)
+		{
+			space_wanted = true;
+			if (this->is_full_() && !terminated)
+				space_ready.wait();
+		}
+
+		space_wanted = false;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool wait_for_space_for(const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->wait_for_space_until(std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool wait_for_space_until(const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		bool result{ true };
+		while (this->is_full_() && !terminated)
+		{
+			space_wanted = true;
+			if (this->is_full_() && !terminated && !space_ready.wait_until(timeout_time))
+			{
+				result = !this->is_full_();
+				break;
+			}
+		}
+
+		space_wanted = false;
+
+		return result;
+	}
+
 	inline void wait_for_data() const
 	{
 		if (!read_enable.is_set() && !terminated)
@@ -356,6 +832,52 @@ public:
 	{
 		return size.load();
 	}
+
+	inline std::size_t get_dropped() const
+	{
+		return dropped.load();
+	}
+
+	// not thread safe; configure before the buffer is shared
+	inline void set_watermarks(const std::size_t & high, const std::size_t & low, watermark::callback_type callback = nullptr)
+	{
+		levels.set(high, low, std::move(callback));
+	}
+
+	inline bool is_high_watermark() const
+	{
+		return levels.is_high();
+	}
+
+private:
+	// 'cyclic_snapshot.h' support: the queued elements oldest first, and refilling an empty buffer
+	inline cyclic_span_pair<value_type> snapshot_segments_() const
+	{
+		value_type * const start{ read_point.load() };
+		std::size_t const count{ get_size() };
+		std::size_t const first{ std::min(count, (std::size_t)(last_point - start) + 1) };
+
+		cyclic_span_pair<value_type> result;
+		result.first = cyclic_span<value_type>(start, first);
+		result.second = cyclic_span<value_type>(data, count - first);
+
+		return result;
+	}
+
+	inline void restore_(const value_type * records, const std::size_t & count)
+	{
+		memcpy(data, records, count * sizeof(value_type));
+		write_point = data + count;
+		size = count;
+
+		if (count > 0)
+			read_enable.set();
+	}
+
+	inline bool is_full_() const
+	{
+		return ((write_point == last_point ? data : write_point + 1) == read_point.load());
+	}
 };
 
 template<typename _Ty>
@@ -371,6 +893,8 @@ public:
 	static constexpr bool is_lock_free{ false };
 	static constexpr bool is_recyclable{ true };
 
+	friend struct cyclic_snapshot_access;
+
 private:
 	value_type * const data;
 	value_type * const last_point;
@@ -379,6 +903,9 @@ private:
 
 	counter_lock size;
 	const std::size_t capacity;
+	std::atomic<std::size_t> dropped;
+
+	watermark levels;
 
 public:
 	cyclic_buffer(const type &) = delete;
@@ -393,6 +920,7 @@ public:
 		assert(_capacity > (std::size_t)1);
 
 		write_point = read_point = data;
+		dropped = 0;
 	}
 
 	~cyclic_buffer()
@@ -423,6 +951,25 @@ public:
 		return data + capacity;
 	}
 
+	// logical view of the queued elements, oldest first; valid while no consumer pops
+	inline cyclic_range<value_type> items() const
+	{
+		return cyclic_range<value_type>(data, capacity, (std::size_t)(read_point - data), get_size());
+	}
+
+	// the queued elements as at most two contiguous runs, oldest first
+	inline cyclic_span_pair<value_type> segments() const
+	{
+		std::size_t const count{ get_size() };
+		std::size_t const first{ std::min(count, (std::size_t)(last_point - read_point) + 1) };
+
+		cyclic_span_pair<value_type> result;
+		result.first = cyclic_span<value_type>(read_point, first);
+		result.second = cyclic_span<value_type>(data, count - first);
+
+		return result;
+	}
+
 	inline value_type push(const value_type & value)
 	{
 		this->wait_for_space();
@@ -431,11 +978,47 @@ public:
 		*write_point = value;
 		(write_point == last_point ? write_point = data : ++write_point);
 
-		size.add();
+		levels.on_add(size.add(), [this] { return size.get_value(); });
 
 		return result;
 	}
 
+	inline bool try_push(const value_type & value, value_type & result)
+	{
+		if (size.get_value() == capacity)
+		{
+			dropped.fetch_add(1);
+			return false;
+		}
+
+		result = this->push(value);
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_push_for(const value_type & value, value_type & result, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_push_until(value, result, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_push_until(const value_type & value, value_type & result, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (size.get_value() == capacity)
+		{
+			if (size.is_terminated() || !this->wait_for_space_until(timeout_time))
+			{
+				dropped.fetch_add(1);
+				return false;
+			}
+		}
+
+		result = this->push(value);
+
+		return true;
+	}
+
 	inline value_type pop(const value_type & value)
 	{
 		this->wait_for_data();
@@ -444,23 +1027,105 @@ public:
 		*read_point = value;
 		(read_point == last_point ? read_point = data : ++read_point);
 
-		size.sub();
+		levels.on_sub(size.sub(), [this] { return size.get_value(); });
 
 		return result;
 	}
 
+	inline bool try_pop(value_type & result, const value_type & value)
+	{
+		if (size.get_value() == 0)
+			return false;
+
+		result = this->pop(value);
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_pop_for(value_type & result, const value_type & value, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_pop_until(result, value, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_pop_until(value_type & result, const value_type & value, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (size.get_value() == 0)
+		{
+			if (size.is_terminated() || !this->wait_for_data_until(timeout_time))
+				return false;
+		}
+
+		result = this->pop(value);
+
+		return true;
+	}
+
+	template<class _Func>
+	inline std::size_t consume_all(_Func && _func)
+	{
+		return this->consume_up_to((std::size_t)-1, std::forward<_Func>(_func));
+	}
+
+	template<class _Func>
+	inline std::size_t consume_up_to(const std::size_t & _count, _Func && _func)
+	{
+		value_type * const start{ read_point };
+		std::size_t count{ size.get_value() };
+		if (_count < count)
+			count = _count;
+
+		std::size_t const first{ (std::size_t)(last_point - start) + 1 };
+		value_type * const first_end{ count < first ? start + count : last_point + 1 };
+		value_type * const second_end{ count < first ? data : data + (count - first) };
+
+		for (value_type * it = start; it != first_end; ++it)
+			_func(*it);
+
+		for (value_type * it = data; it != second_end; ++it)
+			_func(*it);
+
+		read_point = (count < first ? first_end : second_end);
+
+		if (count > 0)
+			levels.on_sub(size.sub(count), [this] { return size.get_value(); });
+
+		return count;
+	}
+
+	template<class _OutIt, class _Rep, class _Period>
+	inline std::size_t pop_batch(_OutIt _out, const value_type & value, std::size_t _max_count, const std::chrono::duration<_Rep, _Period>& max_wait, const std::size_t & _min_count = 1)
+	{
+		auto const timeout_time{ std::chrono::steady_clock::now() + max_wait };
+		if (_max_count > capacity)
+			_max_count = capacity;
+
+		if (this->wait_for_data_until(timeout_time) && (size.get_value() < _max_count))
+			size.wait_for_value_until(_max_count, timeout_time);
+
+		if ((size.get_value() < _min_count) && !size.is_terminated())
+			return 0;
+
+		return this->consume_up_to(_max_count, [&](value_type & item) {
+			*_out = item;
+			++_out;
+			item = value;
+		});
+	}
+
 	inline const value_type operator[](const std::size_t & _index) const
 	{
 		assert(_index < get_size());
 
-		return *(last_point - read_point < _index ? write_point - (get_size() - _index) : read_point + _index);
+		return *((std::size_t)(last_point - read_point) < _index ? data + (_index - (std::size_t)(last_point - read_point) - 1) : read_point + _index);
 	}
 
 	inline value_type & operator[](const std::size_t & _index)
 	{
 		assert(_index < get_size());
 
-		return *(last_point - read_point < _index ? write_point - (get_size() - _index) : read_point + _index);
+		return *((std::size_t)(last_point - read_point) < _index ? data + (_index - (std::size_t)(last_point - read_point) - 1) : read_point + _index);
 	}
 
 	inline void wait_for_space() const
@@ -520,6 +1185,38 @@ public:
 	{
 		return size.get_value();
 	}
+
+	inline std::size_t get_dropped() const
+	{
+		return dropped.load();
+	}
+
+	// not thread safe; configure before the buffer is shared
+	inline void set_watermarks(const std::size_t & high, const std::size_t & low, watermark::callback_type callback = nullptr)
+	{
+		levels.set(high, low, std::move(callback));
+	}
+
+	inline bool is_high_watermark() const
+	{
+		return levels.is_high();
+	}
+
+private:
+	// 'cyclic_snapshot.h' support: the queued elements oldest first, and refilling an empty buffer
+	inline cyclic_span_pair<value_type> snapshot_segments_() const
+	{
+		return segments();
+	}
+
+	inline void restore_(const value_type * records, const std::size_t & count)
+	{
+		memcpy(data, records, count * sizeof(value_type));
+		write_point = (count == capacity ? data : data + count);
+
+		if (count > 0)
+			size.add(count);
+	}
 };
 
 template<typename _Ty>
@@ -535,6 +1232,8 @@ public:
 	static constexpr bool is_lock_free{ false };
 	static constexpr bool is_recyclable{ false };
 
+	friend struct cyclic_snapshot_access;
+
 private:
 	value_type * const data;
 	value_type * const last_point;
@@ -543,6 +1242,9 @@ private:
 
 	counter_lock size;
 	const std::size_t capacity;
+	std::atomic<std::size_t> dropped;
+
+	watermark levels;
 
 public:
 	cyclic_buffer(const type &) = delete;
@@ -557,6 +1259,7 @@ public:
 		assert(_capacity > (std::size_t)1);
 
 		write_point = read_point = data;
+		dropped = 0;
 	}
 
 	~cyclic_buffer()
@@ -587,6 +1290,25 @@ public:
 		return data + capacity;
 	}
 
+	// logical view of the queued elements, oldest first; valid while no consumer pops
+	inline cyclic_range<value_type> items() const
+	{
+		return cyclic_range<value_type>(data, capacity, (std::size_t)(read_point - data), get_size());
+	}
+
+	// the queued elements as at most two contiguous runs, oldest first
+	inline cyclic_span_pair<value_type> segments() const
+	{
+		std::size_t const count{ get_size() };
+		std::size_t const first{ std::min(count, (std::size_t)(last_point - read_point) + 1) };
+
+		cyclic_span_pair<value_type> result;
+		result.first = cyclic_span<value_type>(read_point, first);
+		result.second = cyclic_span<value_type>(data, count - first);
+
+		return result;
+	}
+
 	inline void push(const value_type & value)
 	{
 		this->wait_for_space();
@@ -594,7 +1316,76 @@ public:
 		*write_point = value;
 		(write_point == last_point ? write_point = data : ++write_point);
 
-		size.add();
+		levels.on_add(size.add(), [this] { return size.get_value(); });
+	}
+
+	inline std::size_t push_range(const value_type * values, const std::size_t & count)
+	{
+		std::size_t pushed{ 0 };
+		while ((pushed < count) && !size.is_terminated())
+		{
+			this->wait_for_space();
+
+			std::size_t chunk{ capacity - size.get_value() };
+			if (count - pushed < chunk)
+				chunk = count - pushed;
+
+			std::size_t const first{ (std::size_t)(last_point - write_point) + 1 };
+			if (chunk < first)
+			{
+				std::copy(values + pushed, values + pushed + chunk, write_point);
+				write_point += chunk;
+			}
+			else
+			{
+				std::copy(values + pushed, values + pushed + first, write_point);
+				std::copy(values + pushed + first, values + pushed + chunk, data);
+				write_point = data + (chunk - first);
+			}
+
+			if (chunk > 0)
+				levels.on_add(size.add(chunk), [this] { return size.get_value(); });
+
+			pushed += chunk;
+		}
+
+		return pushed;
+	}
+
+	inline bool try_push(const value_type & value)
+	{
+		if (size.get_value() == capacity)
+		{
+			dropped.fetch_add(1);
+			return false;
+		}
+
+		this->push(value);
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_push_for(const value_type & value, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_push_until(value, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_push_until(const value_type & value, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (size.get_value() == capacity)
+		{
+			if (size.is_terminated() || !this->wait_for_space_until(timeout_time))
+			{
+				dropped.fetch_add(1);
+				return false;
+			}
+		}
+
+		this->push(value);
+
+		return true;
 	}
 
 	inline value_type pop()
@@ -604,23 +1395,104 @@ public:
 		value_type result{ *read_point };
 		(read_point == last_point ? read_point = data : ++read_point);
 
-		size.sub();
+		levels.on_sub(size.sub(), [this] { return size.get_value(); });
 
 		return result;
 	}
 
+	inline bool try_pop(value_type & result)
+	{
+		if (size.get_value() == 0)
+			return false;
+
+		result = this->pop();
+
+		return true;
+	}
+
+	template<class _Rep, class _Period>
+	inline bool try_pop_for(value_type & result, const std::chrono::duration<_Rep, _Period>& rel_time)
+	{
+		return this->try_pop_until(result, std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool try_pop_until(value_type & result, const std::chrono::time_point<_Clock, _Duration>& timeout_time)
+	{
+		while (size.get_value() == 0)
+		{
+			if (size.is_terminated() || !this->wait_for_data_until(timeout_time))
+				return false;
+		}
+
+		result = this->pop();
+
+		return true;
+	}
+
+	template<class _Func>
+	inline std::size_t consume_all(_Func && _func)
+	{
+		return this->consume_up_to((std::size_t)-1, std::forward<_Func>(_func));
+	}
+
+	template<class _Func>
+	inline std::size_t consume_up_to(const std::size_t & _count, _Func && _func)
+	{
+		value_type * const start{ read_point };
+		std::size_t count{ size.get_value() };
+		if (_count < count)
+			count = _count;
+
+		std::size_t const first{ (std::size_t)(last_point - start) + 1 };
+		value_type * const first_end{ count < first ? start + count : last_point + 1 };
+		value_type * const second_end{ count < first ? data : data + (count - first) };
+
+		for (value_type * it = start; it != first_end; ++it)
+			_func(*it);
+
+		for (value_type * it = data; it != second_end; ++it)
+			_func(*it);
+
+		read_point = (count < first ? first_end : second_end);
+
+		if (count > 0)
+			levels.on_sub(size.sub(count), [this] { return size.get_value(); });
+
+		return count;
+	}
+
+	template<class _OutIt, class _Rep, class _Period>
+	inline std::size_t pop_batch(_OutIt _out, std::size_t _max_count, const std::chrono::duration<_Rep, _Period>& max_wait, const std::size_t & _min_count = 1)
+	{
+		auto const timeout_time{ std::chrono::steady_clock::now() + max_wait };
+		if (_max_count > capacity)
+			_max_count = capacity;
+
+		if (this->wait_for_data_until(timeout_time) && (size.get_value() < _max_count))
+			size.wait_for_value_until(_max_count, timeout_time);
+
+		if ((size.get_value() < _min_count) && !size.is_terminated())
+			return 0;
+
+		return this->consume_up_to(_max_count, [&](value_type & item) {
+			*_out = item;
+			++_out;
+		});
+	}
+
 	inline const value_type operator[](const std::size_t & _index) const
 	{
 		assert(_index < get_size());
 
-		return *(last_point - read_point < _index ? write_point - (get_size() - _index) : read_point + _index);
+		return *((std::size_t)(last_point - read_point) < _index ? data + (_index - (std::size_t)(last_point - read_point) - 1) : read_point + _index);
 	}
 
 	inline value_type & operator[](const std::size_t & _index)
 	{
 		assert(_index < get_size());
 
-		return *(last_point - read_point < _index ? write_point - (get_size() - _index) : read_point + _index);
+		return *((std::size_t)(last_point - read_point) < _index ? data + (_index - (std::size_t)(last_point - read_point) - 1) : read_point + _index);
 	}
 
 	inline void wait_for_space() const
@@ -680,6 +1552,38 @@ public:
 	{
 		return size.get_value();
 	}
+
+	inline std::size_t get_dropped() const
+	{
+		return dropped.load();
+	}
+
+	// not thread safe; configure before the buffer is shared
+	inline void set_watermarks(const std::size_t & high, const std::size_t & low, watermark::callback_type callback = nullptr)
+	{
+		levels.set(high, low, std::move(callback));
+	}
+
+	inline bool is_high_watermark() const
+	{
+		return levels.is_high();
+	}
+
+private:
+	// 'cyclic_snapshot.h' support: the queued elements oldest first, and refilling an empty buffer
+	inline cyclic_span_pair<value_type> snapshot_segments_() const
+	{
+		return segments();
+	}
+
+	inline void restore_(const value_type * records, const std::size_t & count)
+	{
+		memcpy(data, records, count * sizeof(value_type));
+		write_point = (count == capacity ? data : data + count);
+
+		if (count > 0)
+			size.add(count);
+	}
 };
 
 template<typename _Ty>
@@ -732,6 +1636,25 @@ public:
 		return data + capacity;
 	}
 
+	// logical view of the stored elements, oldest first
+	inline cyclic_range<value_type> items() const
+	{
+		return cyclic_range<value_type>(data, capacity, (std::size_t)(front_point - data), size);
+	}
+
+	// the stored elements as at most two contiguous runs, oldest first
+	inline cyclic_span_pair<value_type> segments() const
+	{
+		std::size_t const count{ size };
+		std::size_t const first{ std::min(count, (std::size_t)(last_point - front_point) + 1) };
+
+		cyclic_span_pair<value_type> result;
+		result.first = cyclic_span<value_type>(front_point, first);
+		result.second = cyclic_span<value_type>(data, count - first);
+
+		return result;
+	}
+
 	inline value_type push_front(value_type const & _value)
 	{
 		assert(size < capacity);
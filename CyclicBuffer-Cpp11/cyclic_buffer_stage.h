@@ -0,0 +1,113 @@
+#ifndef _CYCLIC_BUFFER_STAGE_H_
+#define _CYCLIC_BUFFER_STAGE_H_
+
+#include <chrono>
+#include <mutex>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "spin_lock.h"
+
+// Producer-local staging area in front of a shared cyclic_buffer.
+// Every producer owns one stage (e.g. 'thread_local'); all stages of a buffer share
+// one producer lock, which is taken once per flush instead of once per element.
+// Producers that bypass the stage must take the same lock around their own push.
+template<class _Buffer, class _Lock = spin_lock>
+class cyclic_buffer_stage
+{
+public:
+	typedef typename _Buffer::value_type value_type;
+	typedef _Buffer buffer_type;
+	typedef _Lock lock_type;
+	typedef cyclic_buffer_stage<_Buffer, _Lock> type;
+	typedef std::chrono::steady_clock clock_type;
+
+protected:
+	buffer_type & buffer_;
+	lock_type & lock_;
+
+	value_type * const data_;
+	const std::size_t capacity_;
+	std::size_t size_;
+
+	const clock_type::duration max_delay_;
+	const bool timed_;
+	clock_type::time_point deadline_;
+
+public:
+	cyclic_buffer_stage(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	cyclic_buffer_stage(buffer_type & _buffer, lock_type & _lock, const std::size_t & _capacity, const clock_type::duration & _max_delay = clock_type::duration::max()) :
+		buffer_(_buffer),
+		lock_(_lock),
+		data_{ (value_type*)malloc(_capacity * sizeof(value_type)) },
+		capacity_{ _capacity },
+		size_{ 0 },
+		max_delay_{ _max_delay },
+		timed_{ _max_delay != clock_type::duration::max() }
+	{
+		static_assert(!buffer_type::is_recyclable, "Error: 'cyclic_buffer_stage' can not stage a recyclable buffer.");
+		assert(_capacity > (std::size_t)0);
+	}
+
+	~cyclic_buffer_stage()
+	{
+		flush();
+		free(data_);
+	}
+
+	inline buffer_type & buffer() const
+	{
+		return buffer_;
+	}
+
+	inline std::size_t get_capacity() const
+	{
+		return capacity_;
+	}
+
+	inline std::size_t get_size() const
+	{
+		return size_;
+	}
+
+	inline void push(const value_type & value)
+	{
+		if (timed_ && (size_ == 0))
+			deadline_ = clock_type::now() + max_delay_;
+
+		data_[size_] = value;
+
+		if ((++size_ == capacity_) || (timed_ && (clock_type::now() >= deadline_)))
+			flush();
+	}
+
+	// publishes everything staged so far; returns the number of elements handed to the buffer
+	inline std::size_t flush()
+	{
+		if (size_ == 0)
+			return 0;
+
+		std::size_t result;
+		{
+			std::lock_guard<lock_type> lock(lock_);
+			result = buffer_.push_range(data_, size_);
+		}
+
+		size_ = 0;
+
+		return result;
+	}
+
+	// flushes if the oldest staged element has waited 'max_delay'; for producers that go idle
+	inline std::size_t poll()
+	{
+		if (timed_ && (size_ > 0) && (clock_type::now() >= deadline_))
+			return flush();
+
+		return 0;
+	}
+};
+
+#endif // !_CYCLIC_BUFFER_STAGE_H_
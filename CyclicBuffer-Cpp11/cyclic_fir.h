@@ -0,0 +1,101 @@
+#ifndef _CYCLIC_FIR_H_
+#define _CYCLIC_FIR_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "cyclic_kernels.h"
+
+// Streaming FIR filter over one or more channels. Each channel keeps its last 'taps'
+// samples twice, 'taps' apart, so the newest window is always one contiguous run and
+// every output sample is a single 'cyclic_kernels::dot' against the reversed taps.
+class cyclic_fir
+{
+private:
+	const std::size_t taps_count;
+	const std::size_t channels;
+
+	float * const taps; // reversed, oldest sample first
+	float * const history; // 2 * taps_count per channel
+	std::size_t * const positions;
+
+public:
+	cyclic_fir(const cyclic_fir&) = delete;
+	cyclic_fir& operator=(const cyclic_fir&) = delete;
+
+	// y[n] = sum(_taps[k] * x[n - k]); the history starts as silence
+	cyclic_fir(const float * _taps, const std::size_t _taps_count, const std::size_t _channels = 1) :
+		taps_count{ _taps_count },
+		channels{ _channels },
+		taps{ (float*)malloc(_taps_count * sizeof(float)) },
+		history{ (float*)malloc(2 * _taps_count * _channels * sizeof(float)) },
+		positions{ (std::size_t*)malloc(_channels * sizeof(std::size_t)) }
+	{
+		assert(_taps_count > (std::size_t)0);
+		assert(_channels > (std::size_t)0);
+
+		for (std::size_t i = 0; i < taps_count; ++i)
+			taps[i] = _taps[taps_count - 1 - i];
+
+		reset();
+	}
+
+	~cyclic_fir()
+	{
+		free(taps);
+		free(history);
+		free(positions);
+	}
+
+	inline void reset()
+	{
+		memset(history, 0, 2 * taps_count * channels * sizeof(float));
+
+		for (std::size_t i = 0; i < channels; ++i)
+			positions[i] = 0;
+	}
+
+	inline float push(const float sample, const std::size_t channel = 0)
+	{
+		assert(channel < channels);
+
+		float * const line{ history + 2 * taps_count * channel };
+		std::size_t & position{ positions[channel] };
+
+		line[position] = line[position + taps_count] = sample;
+		(position == taps_count - 1 ? position = 0 : ++position);
+
+		// after the write the window 'position .. position + taps_count' is oldest first
+		return cyclic_kernels::dot(taps, line + position, taps_count);
+	}
+
+	// filters 'count' samples of one channel; 'output' may alias 'input'
+	inline void process(const float * input, float * output, const std::size_t count, const std::size_t channel = 0)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			output[i] = push(input[i], channel);
+	}
+
+	// filters 'frames' frames of 'channels' interleaved samples
+	inline void process_interleaved(const float * input, float * output, const std::size_t frames)
+	{
+		for (std::size_t i = 0; i < frames; ++i)
+		{
+			for (std::size_t channel = 0; channel < channels; ++channel)
+				output[i * channels + channel] = push(input[i * channels + channel], channel);
+		}
+	}
+
+	inline std::size_t get_taps_count() const
+	{
+		return taps_count;
+	}
+
+	inline std::size_t get_channels() const
+	{
+		return channels;
+	}
+};
+
+#endif // !_CYCLIC_FIR_H_
@@ -0,0 +1,190 @@
+#ifndef _CYCLIC_ITERATOR_H_
+#define _CYCLIC_ITERATOR_H_
+
+#include <iterator>
+#include <type_traits>
+#include <stddef.h>
+#include <assert.h>
+
+// Random access iterator over the logical contents of a ring: position 0 is the oldest
+// element. Only the wrap is computed per step, never the buffer size.
+template<typename _Ty>
+class cyclic_iterator
+{
+public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef typename std::remove_const<_Ty>::type value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef _Ty * pointer;
+	typedef _Ty & reference;
+	typedef cyclic_iterator<_Ty> type;
+
+private:
+	pointer data_;
+	std::size_t capacity_;
+	std::size_t front_;
+	difference_type index_;
+
+public:
+	cyclic_iterator() :
+		data_{ nullptr },
+		capacity_{ 0 },
+		front_{ 0 },
+		index_{ 0 }
+	{ }
+
+	// '_front' is the slot of the oldest element, '_index' the logical position
+	cyclic_iterator(pointer const _data, const std::size_t & _capacity, const std::size_t & _front, const difference_type & _index) :
+		data_{ _data },
+		capacity_{ _capacity },
+		front_{ _front },
+		index_{ _index }
+	{ }
+
+	inline reference operator*() const
+	{
+		return data_[slot_(index_)];
+	}
+
+	inline pointer operator->() const
+	{
+		return data_ + slot_(index_);
+	}
+
+	inline reference operator[](const difference_type & offset) const
+	{
+		return data_[slot_(index_ + offset)];
+	}
+
+	inline type & operator++()
+	{
+		++index_;
+		return *this;
+	}
+
+	inline type operator++(int)
+	{
+		type result{ *this };
+		++index_;
+		return result;
+	}
+
+	inline type & operator--()
+	{
+		--index_;
+		return *this;
+	}
+
+	inline type operator--(int)
+	{
+		type result{ *this };
+		--index_;
+		return result;
+	}
+
+	inline type & operator+=(const difference_type & offset)
+	{
+		index_ += offset;
+		return *this;
+	}
+
+	inline type & operator-=(const difference_type & offset)
+	{
+		index_ -= offset;
+		return *this;
+	}
+
+	inline type operator+(const difference_type & offset) const
+	{
+		return type{ data_, capacity_, front_, index_ + offset };
+	}
+
+	inline type operator-(const difference_type & offset) const
+	{
+		return type{ data_, capacity_, front_, index_ - offset };
+	}
+
+	friend inline type operator+(const difference_type & offset, const type & it)
+	{
+		return it + offset;
+	}
+
+	inline difference_type operator-(const type & other) const
+	{
+		assert(data_ == other.data_);
+
+		return index_ - other.index_;
+	}
+
+	inline bool operator==(const type & other) const
+	{
+		return (index_ == other.index_);
+	}
+
+	inline bool operator!=(const type & other) const
+	{
+		return (index_ != other.index_);
+	}
+
+	inline bool operator<(const type & other) const
+	{
+		return (index_ < other.index_);
+	}
+
+	inline bool operator>(const type & other) const
+	{
+		return (index_ > other.index_);
+	}
+
+	inline bool operator<=(const type & other) const
+	{
+		return (index_ <= other.index_);
+	}
+
+	inline bool operator>=(const type & other) const
+	{
+		return (index_ >= other.index_);
+	}
+
+private:
+	inline std::size_t slot_(const difference_type & index) const
+	{
+		std::size_t const slot{ front_ + (std::size_t)index };
+
+		return (slot < capacity_ ? slot : slot - capacity_);
+	}
+};
+
+template<typename _Ty>
+class cyclic_range
+{
+public:
+	typedef cyclic_iterator<_Ty> iterator;
+
+private:
+	iterator begin_;
+	iterator end_;
+
+public:
+	cyclic_range(_Ty * const _data, const std::size_t & _capacity, const std::size_t & _front, const std::size_t & _size) :
+		begin_{ _data, _capacity, _front, 0 },
+		end_{ _data, _capacity, _front, (std::ptrdiff_t)_size }
+	{ }
+
+	inline iterator begin() const
+	{
+		return begin_;
+	}
+
+	inline iterator end() const
+	{
+		return end_;
+	}
+
+	inline std::size_t size() const
+	{
+		return (std::size_t)(end_ - begin_);
+	}
+};
+
+#endif // !_CYCLIC_ITERATOR_H_
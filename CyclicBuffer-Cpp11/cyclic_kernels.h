@@ -0,0 +1,828 @@
+#ifndef _CYCLIC_KERNELS_H_
+#define _CYCLIC_KERNELS_H_
+
+#include <atomic>
+#include <type_traits>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bit_ops.h"
+#include "cyclic_span.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CYCLIC_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CYCLIC_TARGET_AVX2
+#define CYCLIC_TARGET_AVX512
+#else
+#define CYCLIC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define CYCLIC_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+#endif
+
+// Bulk kernels over contiguous runs and over the two segments of a ring
+// ('segments()' of the buffers). float and int32_t (uint32_t and uint64_t for sequence
+// numbers) run AVX2 or AVX-512 code picked once at run time; every other type, and every
+// other CPU, takes the scalar loop.
+// Vector sums add in a different order than the scalar loop, so floating point results
+// may differ in the last bits.
+namespace cyclic_kernels
+{
+	enum class isa
+	{
+		scalar,
+		avx2,
+		avx512
+	};
+
+	template<typename _Ty>
+	struct sum_traits
+	{
+		typedef typename std::conditional<std::is_floating_point<_Ty>::value, double,
+			typename std::conditional<std::is_signed<_Ty>::value, int64_t, uint64_t>::type>::type type;
+	};
+
+	namespace detail
+	{
+		inline isa detect()
+		{
+#ifdef CYCLIC_KERNELS_X86
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return isa::scalar;
+
+			__cpuid(info, 1);
+			bool const fma{ (info[2] & (1 << 12)) != 0 };
+			bool const os_xsave{ (info[2] & (1 << 27)) != 0 };
+			bool const avx{ (info[2] & (1 << 28)) != 0 };
+			if (!os_xsave || !avx || !fma)
+				return isa::scalar;
+
+			unsigned long long const xcr0{ _xgetbv(0) };
+			if ((xcr0 & 0x6) != 0x6)
+				return isa::scalar;
+
+			__cpuidex(info, 7, 0);
+			bool const avx2{ (info[1] & (1 << 5)) != 0 };
+			bool const avx512{ (info[1] & (1 << 16)) != 0 };
+
+			if (avx512 && ((xcr0 & 0xE6) == 0xE6))
+				return isa::avx512;
+
+			return (avx2 ? isa::avx2 : isa::scalar);
+#else
+			__builtin_cpu_init();
+
+			if (__builtin_cpu_supports("avx512f"))
+				return isa::avx512;
+
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+				return isa::avx2;
+
+			return isa::scalar;
+#endif
+#else
+			return isa::scalar;
+#endif
+		}
+
+		inline isa detected()
+		{
+			static const isa result{ detect() };
+
+			return result;
+		}
+
+		inline std::atomic<isa> & selected()
+		{
+			static std::atomic<isa> result{ detected() };
+
+			return result;
+		}
+
+		// scalar
+
+		template<typename _Ty>
+		inline typename sum_traits<_Ty>::type sum(const _Ty * data, const std::size_t count)
+		{
+			typename sum_traits<_Ty>::type result{ 0 };
+			for (std::size_t i = 0; i < count; ++i)
+				result += data[i];
+
+			return result;
+		}
+
+		template<typename _Ty>
+		inline void min_max(const _Ty * data, const std::size_t count, _Ty & minimum, _Ty & maximum)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (data[i] < minimum)
+					minimum = data[i];
+
+				if (maximum < data[i])
+					maximum = data[i];
+			}
+		}
+
+		template<typename _Ty>
+		inline std::size_t count_above(const _Ty * data, const std::size_t count, const _Ty threshold)
+		{
+			std::size_t result{ 0 };
+			for (std::size_t i = 0; i < count; ++i)
+				result += (threshold < data[i] ? 1 : 0);
+
+			return result;
+		}
+
+		template<typename _Ty>
+		inline std::size_t find(const _Ty * data, const std::size_t count, const _Ty value)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (data[i] == value)
+					return i;
+			}
+
+			return count;
+		}
+
+		template<typename _Ty>
+		inline void scale(const _Ty * data, const std::size_t count, const float factor, float * output)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				output[i] = (float)data[i] * factor;
+		}
+
+		inline float dot(const float * left, const float * right, const std::size_t count)
+		{
+			float result{ 0 };
+			for (std::size_t i = 0; i < count; ++i)
+				result += left[i] * right[i];
+
+			return result;
+		}
+
+		// sets bit 'first + i' of 'mask' for every 'data[i]' in [base, base + window) modulo 'modulus'
+		template<typename _Ty>
+		inline std::size_t within_window(const _Ty * data, const std::size_t count, const _Ty base, const _Ty modulus, const _Ty window, uint64_t * mask, const std::size_t first = 0)
+		{
+			std::size_t result{ 0 };
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				_Ty const distance{ (_Ty)(data[i] - base + (data[i] < base ? modulus : (_Ty)0)) };
+				if (distance < window)
+				{
+					bit_ops::set(mask, first + i);
+					++result;
+				}
+			}
+
+			return result;
+		}
+
+#ifdef CYCLIC_KERNELS_X86
+		// AVX2
+
+		CYCLIC_TARGET_AVX2 inline double sum_avx2(const float * data, const std::size_t count)
+		{
+			__m256d low{ _mm256_setzero_pd() }, high{ _mm256_setzero_pd() };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+			{
+				low = _mm256_add_pd(low, _mm256_cvtps_pd(_mm_loadu_ps(data + i)));
+				high = _mm256_add_pd(high, _mm256_cvtps_pd(_mm_loadu_ps(data + i + 4)));
+			}
+
+			alignas(32) double lanes[4];
+			_mm256_store_pd(lanes, _mm256_add_pd(low, high));
+
+			return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum(data + i, count - i);
+		}
+
+		CYCLIC_TARGET_AVX2 inline int64_t sum_avx2(const int32_t * data, const std::size_t count)
+		{
+			__m256i low{ _mm256_setzero_si256() }, high{ _mm256_setzero_si256() };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+			{
+				low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(data + i))));
+				high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(data + i + 4))));
+			}
+
+			alignas(32) int64_t lanes[4];
+			_mm256_store_si256((__m256i*)lanes, _mm256_add_epi64(low, high));
+
+			return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum(data + i, count - i);
+		}
+
+		CYCLIC_TARGET_AVX2 inline void min_max_avx2(const float * data, const std::size_t count, float & minimum, float & maximum)
+		{
+			std::size_t i{ 0 };
+
+			if (count >= 8)
+			{
+				__m256 low{ _mm256_set1_ps(minimum) }, high{ _mm256_set1_ps(maximum) };
+				for (/* nothing */; i + 8 <= count; i += 8)
+				{
+					__m256 const values{ _mm256_loadu_ps(data + i) };
+					low = _mm256_min_ps(low, values);
+					high = _mm256_max_ps(high, values);
+				}
+
+				alignas(32) float lanes[8];
+				_mm256_store_ps(lanes, low);
+				min_max(lanes, 8, minimum, maximum);
+				_mm256_store_ps(lanes, high);
+				min_max(lanes, 8, minimum, maximum);
+			}
+
+			min_max(data + i, count - i, minimum, maximum);
+		}
+
+		CYCLIC_TARGET_AVX2 inline void min_max_avx2(const int32_t * data, const std::size_t count, int32_t & minimum, int32_t & maximum)
+		{
+			std::size_t i{ 0 };
+
+			if (count >= 8)
+			{
+				__m256i low{ _mm256_set1_epi32(minimum) }, high{ _mm256_set1_epi32(maximum) };
+				for (/* nothing */; i + 8 <= count; i += 8)
+				{
+					__m256i const values{ _mm256_loadu_si256((const __m256i*)(data + i)) };
+					low = _mm256_min_epi32(low, values);
+					high = _mm256_max_epi32(high, values);
+				}
+
+				alignas(32) int32_t lanes[8];
+				_mm256_store_si256((__m256i*)lanes, low);
+				min_max(lanes, 8, minimum, maximum);
+				_mm256_store_si256((__m256i*)lanes, high);
+				min_max(lanes, 8, minimum, maximum);
+			}
+
+			min_max(data + i, count - i, minimum, maximum);
+		}
+
+		CYCLIC_TARGET_AVX2 inline std::size_t count_above_avx2(const float * data, const std::size_t count, const float threshold)
+		{
+			__m256 const limit{ _mm256_set1_ps(threshold) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+				result += bit_ops::popcount((uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), limit, _CMP_GT_OQ)));
+
+			return result + count_above(data + i, count - i, threshold);
+		}
+
+		CYCLIC_TARGET_AVX2 inline std::size_t count_above_avx2(const int32_t * data, const std::size_t count, const int32_t threshold)
+		{
+			__m256i const limit{ _mm256_set1_epi32(threshold) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+				result += bit_ops::popcount((uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(data + i)), limit))));
+
+			return result + count_above(data + i, count - i, threshold);
+		}
+
+		CYCLIC_TARGET_AVX2 inline std::size_t find_avx2(const float * data, const std::size_t count, const float value)
+		{
+			__m256 const target{ _mm256_set1_ps(value) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+			{
+				uint32_t const mask{ (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), target, _CMP_EQ_OQ)) };
+				if (mask != 0)
+					return i + bit_ops::count_trailing_zeros(mask);
+			}
+
+			return i + find(data + i, count - i, value);
+		}
+
+		CYCLIC_TARGET_AVX2 inline std::size_t find_avx2(const int32_t * data, const std::size_t count, const int32_t value)
+		{
+			__m256i const target{ _mm256_set1_epi32(value) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+			{
+				uint32_t const mask{ (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i)), target))) };
+				if (mask != 0)
+					return i + bit_ops::count_trailing_zeros(mask);
+			}
+
+			return i + find(data + i, count - i, value);
+		}
+
+		CYCLIC_TARGET_AVX2 inline void scale_avx2(const float * data, const std::size_t count, const float factor, float * output)
+		{
+			__m256 const multiplier{ _mm256_set1_ps(factor) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), multiplier));
+
+			scale(data + i, count - i, factor, output + i);
+		}
+
+		CYCLIC_TARGET_AVX2 inline void scale_avx2(const int32_t * data, const std::size_t count, const float factor, float * output)
+		{
+			__m256 const multiplier{ _mm256_set1_ps(factor) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(data + i))), multiplier));
+
+			scale(data + i, count - i, factor, output + i);
+		}
+
+		CYCLIC_TARGET_AVX2 inline float dot_avx2(const float * left, const float * right, const std::size_t count)
+		{
+			__m256 first{ _mm256_setzero_ps() }, second{ _mm256_setzero_ps() };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+			{
+				first = _mm256_fmadd_ps(_mm256_loadu_ps(left + i), _mm256_loadu_ps(right + i), first);
+				second = _mm256_fmadd_ps(_mm256_loadu_ps(left + i + 8), _mm256_loadu_ps(right + i + 8), second);
+			}
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+				first = _mm256_fmadd_ps(_mm256_loadu_ps(left + i), _mm256_loadu_ps(right + i), first);
+
+			alignas(32) float lanes[8];
+			_mm256_store_ps(lanes, _mm256_add_ps(first, second));
+
+			return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])) + dot(left + i, right + i, count - i);
+		}
+
+		// AVX2 has signed compares only; flipping the sign bit makes them unsigned
+		CYCLIC_TARGET_AVX2 inline std::size_t within_window_avx2(const uint32_t * data, const std::size_t count, const uint32_t base, const uint32_t modulus, const uint32_t window, uint64_t * mask)
+		{
+			__m256i const sign{ _mm256_set1_epi32((int32_t)0x80000000u) };
+			__m256i const start{ _mm256_set1_epi32((int32_t)base) };
+			__m256i const start_signed{ _mm256_xor_si256(start, sign) };
+			__m256i const wrap{ _mm256_set1_epi32((int32_t)modulus) };
+			__m256i const limit_signed{ _mm256_xor_si256(_mm256_set1_epi32((int32_t)window), sign) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+			{
+				__m256i const values{ _mm256_loadu_si256((const __m256i*)(data + i)) };
+				__m256i const behind{ _mm256_cmpgt_epi32(start_signed, _mm256_xor_si256(values, sign)) };
+				__m256i const distance{ _mm256_add_epi32(_mm256_sub_epi32(values, start), _mm256_and_si256(behind, wrap)) };
+				uint32_t const bits{ (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(limit_signed, _mm256_xor_si256(distance, sign)))) };
+
+				mask[i / bit_ops::word_bits] |= (uint64_t)bits << (i % bit_ops::word_bits);
+				result += bit_ops::popcount(bits);
+			}
+
+			return result + within_window(data + i, count - i, base, modulus, window, mask, i);
+		}
+
+		CYCLIC_TARGET_AVX2 inline std::size_t within_window_avx2(const uint64_t * data, const std::size_t count, const uint64_t base, const uint64_t modulus, const uint64_t window, uint64_t * mask)
+		{
+			__m256i const sign{ _mm256_set1_epi64x((int64_t)0x8000000000000000ull) };
+			__m256i const start{ _mm256_set1_epi64x((int64_t)base) };
+			__m256i const start_signed{ _mm256_xor_si256(start, sign) };
+			__m256i const wrap{ _mm256_set1_epi64x((int64_t)modulus) };
+			__m256i const limit_signed{ _mm256_xor_si256(_mm256_set1_epi64x((int64_t)window), sign) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 4 <= count; i += 4)
+			{
+				__m256i const values{ _mm256_loadu_si256((const __m256i*)(data + i)) };
+				__m256i const behind{ _mm256_cmpgt_epi64(start_signed, _mm256_xor_si256(values, sign)) };
+				__m256i const distance{ _mm256_add_epi64(_mm256_sub_epi64(values, start), _mm256_and_si256(behind, wrap)) };
+				uint32_t const bits{ (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(limit_signed, _mm256_xor_si256(distance, sign)))) };
+
+				mask[i / bit_ops::word_bits] |= (uint64_t)bits << (i % bit_ops::word_bits);
+				result += bit_ops::popcount(bits);
+			}
+
+			return result + within_window(data + i, count - i, base, modulus, window, mask, i);
+		}
+
+		// AVX-512
+
+		CYCLIC_TARGET_AVX512 inline double sum_avx512(const float * data, const std::size_t count)
+		{
+			__m512d low{ _mm512_setzero_pd() }, high{ _mm512_setzero_pd() };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+			{
+				low = _mm512_add_pd(low, _mm512_cvtps_pd(_mm256_loadu_ps(data + i)));
+				high = _mm512_add_pd(high, _mm512_cvtps_pd(_mm256_loadu_ps(data + i + 8)));
+			}
+
+			return _mm512_reduce_add_pd(_mm512_add_pd(low, high)) + sum(data + i, count - i);
+		}
+
+		CYCLIC_TARGET_AVX512 inline int64_t sum_avx512(const int32_t * data, const std::size_t count)
+		{
+			__m512i low{ _mm512_setzero_si512() }, high{ _mm512_setzero_si512() };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+			{
+				low = _mm512_add_epi64(low, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(data + i))));
+				high = _mm512_add_epi64(high, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(data + i + 8))));
+			}
+
+			return _mm512_reduce_add_epi64(_mm512_add_epi64(low, high)) + sum(data + i, count - i);
+		}
+
+		CYCLIC_TARGET_AVX512 inline void min_max_avx512(const float * data, const std::size_t count, float & minimum, float & maximum)
+		{
+			std::size_t i{ 0 };
+
+			if (count >= 16)
+			{
+				__m512 low{ _mm512_set1_ps(minimum) }, high{ _mm512_set1_ps(maximum) };
+				for (/* nothing */; i + 16 <= count; i += 16)
+				{
+					__m512 const values{ _mm512_loadu_ps(data + i) };
+					low = _mm512_min_ps(low, values);
+					high = _mm512_max_ps(high, values);
+				}
+
+				minimum = _mm512_reduce_min_ps(low);
+				maximum = _mm512_reduce_max_ps(high);
+			}
+
+			min_max(data + i, count - i, minimum, maximum);
+		}
+
+		CYCLIC_TARGET_AVX512 inline void min_max_avx512(const int32_t * data, const std::size_t count, int32_t & minimum, int32_t & maximum)
+		{
+			std::size_t i{ 0 };
+
+			if (count >= 16)
+			{
+				__m512i low{ _mm512_set1_epi32(minimum) }, high{ _mm512_set1_epi32(maximum) };
+				for (/* nothing */; i + 16 <= count; i += 16)
+				{
+					__m512i const values{ _mm512_loadu_si512(data + i) };
+					low = _mm512_min_epi32(low, values);
+					high = _mm512_max_epi32(high, values);
+				}
+
+				minimum = _mm512_reduce_min_epi32(low);
+				maximum = _mm512_reduce_max_epi32(high);
+			}
+
+			min_max(data + i, count - i, minimum, maximum);
+		}
+
+		CYCLIC_TARGET_AVX512 inline std::size_t count_above_avx512(const float * data, const std::size_t count, const float threshold)
+		{
+			__m512 const limit{ _mm512_set1_ps(threshold) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+				result += bit_ops::popcount((uint32_t)_mm512_cmp_ps_mask(_mm512_loadu_ps(data + i), limit, _CMP_GT_OQ));
+
+			return result + count_above(data + i, count - i, threshold);
+		}
+
+		CYCLIC_TARGET_AVX512 inline std::size_t count_above_avx512(const int32_t * data, const std::size_t count, const int32_t threshold)
+		{
+			__m512i const limit{ _mm512_set1_epi32(threshold) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+				result += bit_ops::popcount((uint32_t)_mm512_cmpgt_epi32_mask(_mm512_loadu_si512(data + i), limit));
+
+			return result + count_above(data + i, count - i, threshold);
+		}
+
+		CYCLIC_TARGET_AVX512 inline std::size_t find_avx512(const float * data, const std::size_t count, const float value)
+		{
+			__m512 const target{ _mm512_set1_ps(value) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+			{
+				uint32_t const mask{ (uint32_t)_mm512_cmp_ps_mask(_mm512_loadu_ps(data + i), target, _CMP_EQ_OQ) };
+				if (mask != 0)
+					return i + bit_ops::count_trailing_zeros(mask);
+			}
+
+			return i + find(data + i, count - i, value);
+		}
+
+		CYCLIC_TARGET_AVX512 inline std::size_t find_avx512(const int32_t * data, const std::size_t count, const int32_t value)
+		{
+			__m512i const target{ _mm512_set1_epi32(value) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+			{
+				uint32_t const mask{ (uint32_t)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), target) };
+				if (mask != 0)
+					return i + bit_ops::count_trailing_zeros(mask);
+			}
+
+			return i + find(data + i, count - i, value);
+		}
+
+		CYCLIC_TARGET_AVX512 inline void scale_avx512(const float * data, const std::size_t count, const float factor, float * output)
+		{
+			__m512 const multiplier{ _mm512_set1_ps(factor) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+				_mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_loadu_ps(data + i), multiplier));
+
+			scale(data + i, count - i, factor, output + i);
+		}
+
+		CYCLIC_TARGET_AVX512 inline void scale_avx512(const int32_t * data, const std::size_t count, const float factor, float * output)
+		{
+			__m512 const multiplier{ _mm512_set1_ps(factor) };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+				_mm512_storeu_ps(output + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_loadu_si512(data + i)), multiplier));
+
+			scale(data + i, count - i, factor, output + i);
+		}
+
+		CYCLIC_TARGET_AVX512 inline float dot_avx512(const float * left, const float * right, const std::size_t count)
+		{
+			__m512 first{ _mm512_setzero_ps() }, second{ _mm512_setzero_ps() };
+			std::size_t i{ 0 };
+
+			for (/* nothing */; i + 32 <= count; i += 32)
+			{
+				first = _mm512_fmadd_ps(_mm512_loadu_ps(left + i), _mm512_loadu_ps(right + i), first);
+				second = _mm512_fmadd_ps(_mm512_loadu_ps(left + i + 16), _mm512_loadu_ps(right + i + 16), second);
+			}
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+				first = _mm512_fmadd_ps(_mm512_loadu_ps(left + i), _mm512_loadu_ps(right + i), first);
+
+			return _mm512_reduce_add_ps(_mm512_add_ps(first, second)) + dot(left + i, right + i, count - i);
+		}
+
+		CYCLIC_TARGET_AVX512 inline std::size_t within_window_avx512(const uint32_t * data, const std::size_t count, const uint32_t base, const uint32_t modulus, const uint32_t window, uint64_t * mask)
+		{
+			__m512i const start{ _mm512_set1_epi32((int32_t)base) };
+			__m512i const wrap{ _mm512_set1_epi32((int32_t)modulus) };
+			__m512i const limit{ _mm512_set1_epi32((int32_t)window) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 16 <= count; i += 16)
+			{
+				__m512i const values{ _mm512_loadu_si512(data + i) };
+				__mmask16 const behind{ _mm512_cmplt_epu32_mask(values, start) };
+				__m512i const distance{ _mm512_mask_add_epi32(_mm512_sub_epi32(values, start), behind, _mm512_sub_epi32(values, start), wrap) };
+				uint32_t const bits{ (uint32_t)_mm512_cmplt_epu32_mask(distance, limit) };
+
+				mask[i / bit_ops::word_bits] |= (uint64_t)bits << (i % bit_ops::word_bits);
+				result += bit_ops::popcount(bits);
+			}
+
+			return result + within_window(data + i, count - i, base, modulus, window, mask, i);
+		}
+
+		CYCLIC_TARGET_AVX512 inline std::size_t within_window_avx512(const uint64_t * data, const std::size_t count, const uint64_t base, const uint64_t modulus, const uint64_t window, uint64_t * mask)
+		{
+			__m512i const start{ _mm512_set1_epi64((int64_t)base) };
+			__m512i const wrap{ _mm512_set1_epi64((int64_t)modulus) };
+			__m512i const limit{ _mm512_set1_epi64((int64_t)window) };
+			std::size_t result{ 0 }, i{ 0 };
+
+			for (/* nothing */; i + 8 <= count; i += 8)
+			{
+				__m512i const values{ _mm512_loadu_si512(data + i) };
+				__mmask8 const behind{ _mm512_cmplt_epu64_mask(values, start) };
+				__m512i const distance{ _mm512_mask_add_epi64(_mm512_sub_epi64(values, start), behind, _mm512_sub_epi64(values, start), wrap) };
+				uint32_t const bits{ (uint32_t)_mm512_cmplt_epu64_mask(distance, limit) };
+
+				mask[i / bit_ops::word_bits] |= (uint64_t)bits << (i % bit_ops::word_bits);
+				result += bit_ops::popcount(bits);
+			}
+
+			return result + within_window(data + i, count - i, base, modulus, window, mask, i);
+		}
+#endif
+	}
+
+	// the instruction set in use; defaults to the best one the CPU and OS support
+	inline isa get_isa()
+	{
+		return detail::selected().load(std::memory_order_relaxed);
+	}
+
+	// restricts dispatch, e.g. to compare paths; requests above the CPU's level are capped
+	inline void set_isa(const isa level)
+	{
+		detail::selected().store((int)level > (int)detail::detected() ? detail::detected() : level, std::memory_order_relaxed);
+	}
+
+#ifdef CYCLIC_KERNELS_X86
+#define CYCLIC_KERNELS_DISPATCH(name, ...) \
+	switch (get_isa()) \
+	{ \
+	case isa::avx512: return detail::name##_avx512(__VA_ARGS__); \
+	case isa::avx2: return detail::name##_avx2(__VA_ARGS__); \
+	default: return detail::name(__VA_ARGS__); \
+	}
+#else
+#define CYCLIC_KERNELS_DISPATCH(name, ...) \
+	return detail::name(__VA_ARGS__);
+#endif
+
+	// contiguous runs
+
+	template<typename _Ty>
+	inline typename sum_traits<_Ty>::type sum(const _Ty * data, const std::size_t count)
+	{
+		return detail::sum(data, count);
+	}
+
+	inline double sum(const float * data, const std::size_t count)
+	{
+		CYCLIC_KERNELS_DISPATCH(sum, data, count)
+	}
+
+	inline int64_t sum(const int32_t * data, const std::size_t count)
+	{
+		CYCLIC_KERNELS_DISPATCH(sum, data, count)
+	}
+
+	// folds the run into 'minimum'/'maximum', which the caller seeds
+	template<typename _Ty>
+	inline void min_max(const _Ty * data, const std::size_t count, _Ty & minimum, _Ty & maximum)
+	{
+		detail::min_max(data, count, minimum, maximum);
+	}
+
+	inline void min_max(const float * data, const std::size_t count, float & minimum, float & maximum)
+	{
+		CYCLIC_KERNELS_DISPATCH(min_max, data, count, minimum, maximum)
+	}
+
+	inline void min_max(const int32_t * data, const std::size_t count, int32_t & minimum, int32_t & maximum)
+	{
+		CYCLIC_KERNELS_DISPATCH(min_max, data, count, minimum, maximum)
+	}
+
+	// elements strictly greater than 'threshold'
+	template<typename _Ty>
+	inline std::size_t count_above(const _Ty * data, const std::size_t count, const _Ty threshold)
+	{
+		return detail::count_above(data, count, threshold);
+	}
+
+	inline std::size_t count_above(const float * data, const std::size_t count, const float threshold)
+	{
+		CYCLIC_KERNELS_DISPATCH(count_above, data, count, threshold)
+	}
+
+	inline std::size_t count_above(const int32_t * data, const std::size_t count, const int32_t threshold)
+	{
+		CYCLIC_KERNELS_DISPATCH(count_above, data, count, threshold)
+	}
+
+	// index of the first element equal to 'value', 'count' when there is none
+	template<typename _Ty>
+	inline std::size_t find(const _Ty * data, const std::size_t count, const _Ty value)
+	{
+		return detail::find(data, count, value);
+	}
+
+	inline std::size_t find(const float * data, const std::size_t count, const float value)
+	{
+		CYCLIC_KERNELS_DISPATCH(find, data, count, value)
+	}
+
+	inline std::size_t find(const int32_t * data, const std::size_t count, const int32_t value)
+	{
+		CYCLIC_KERNELS_DISPATCH(find, data, count, value)
+	}
+
+	// output[i] = float(data[i]) * factor
+	template<typename _Ty>
+	inline void scale(const _Ty * data, const std::size_t count, const float factor, float * output)
+	{
+		detail::scale(data, count, factor, output);
+	}
+
+	inline void scale(const float * data, const std::size_t count, const float factor, float * output)
+	{
+		CYCLIC_KERNELS_DISPATCH(scale, data, count, factor, output)
+	}
+
+	inline void scale(const int32_t * data, const std::size_t count, const float factor, float * output)
+	{
+		CYCLIC_KERNELS_DISPATCH(scale, data, count, factor, output)
+	}
+
+	inline float dot(const float * left, const float * right, const std::size_t count)
+	{
+		CYCLIC_KERNELS_DISPATCH(dot, left, right, count)
+	}
+
+	// Wrap-aware window test over a burst of sequence numbers, all below 'modulus': bit i of
+	// 'mask' ('bit_ops::word_count(count)' words, overwritten) is set when 'data[i]' lies in
+	// [base, base + window) modulo 'modulus'. Returns the number of bits set. A 'modulus'
+	// of 0 stands for 2^bits: the numbers use the whole type and wrap with it.
+	template<typename _Ty>
+	inline std::size_t within_window(const _Ty * data, const std::size_t count, const _Ty base, const _Ty modulus, const _Ty window, uint64_t * mask)
+	{
+		static_assert(std::is_unsigned<_Ty>::value, "Error: 'within_window' sequence numbers must be unsigned.");
+
+		memset(mask, 0, bit_ops::word_count(count) * sizeof(uint64_t));
+
+		return detail::within_window(data, count, base, modulus, window, mask);
+	}
+
+	inline std::size_t within_window(const uint32_t * data, const std::size_t count, const uint32_t base, const uint32_t modulus, const uint32_t window, uint64_t * mask)
+	{
+		memset(mask, 0, bit_ops::word_count(count) * sizeof(uint64_t));
+
+		CYCLIC_KERNELS_DISPATCH(within_window, data, count, base, modulus, window, mask)
+	}
+
+	inline std::size_t within_window(const uint64_t * data, const std::size_t count, const uint64_t base, const uint64_t modulus, const uint64_t window, uint64_t * mask)
+	{
+		memset(mask, 0, bit_ops::word_count(count) * sizeof(uint64_t));
+
+		CYCLIC_KERNELS_DISPATCH(within_window, data, count, base, modulus, window, mask)
+	}
+
+	// RFC 1982 order against one reference: bit i of 'mask' is set when 'data[i]' is newer
+	// than 'reference', i.e. less than half the modulus ahead of it; 'modulus' 0 as above
+	template<typename _Ty>
+	inline std::size_t newer_than(const _Ty * data, const std::size_t count, const _Ty reference, const _Ty modulus, uint64_t * mask)
+	{
+		// the largest number, kept in '_Ty' so a full-width 0 does not promote to -1
+		_Ty const maximum{ (_Ty)(modulus - 1) };
+		_Ty const next{ (_Ty)(reference == maximum ? 0 : reference + 1) };
+
+		return within_window(data, count, next, modulus, (_Ty)(maximum / 2), mask);
+	}
+
+#undef CYCLIC_KERNELS_DISPATCH
+
+	// ring segments
+
+	template<typename _Ty>
+	inline typename sum_traits<_Ty>::type sum(const cyclic_span_pair<_Ty> & parts)
+	{
+		return sum((const _Ty*)parts.first.data(), parts.first.size()) + sum((const _Ty*)parts.second.data(), parts.second.size());
+	}
+
+	// false when the ring is empty
+	template<typename _Ty>
+	inline bool min_max(const cyclic_span_pair<_Ty> & parts, _Ty & minimum, _Ty & maximum)
+	{
+		if (parts.empty())
+			return false;
+
+		minimum = maximum = parts[0];
+		min_max((const _Ty*)parts.first.data(), parts.first.size(), minimum, maximum);
+		min_max((const _Ty*)parts.second.data(), parts.second.size(), minimum, maximum);
+
+		return true;
+	}
+
+	template<typename _Ty>
+	inline std::size_t count_above(const cyclic_span_pair<_Ty> & parts, const _Ty threshold)
+	{
+		return count_above((const _Ty*)parts.first.data(), parts.first.size(), threshold) + count_above((const _Ty*)parts.second.data(), parts.second.size(), threshold);
+	}
+
+	// logical index of the first match, 'parts.size()' when there is none
+	template<typename _Ty>
+	inline std::size_t find(const cyclic_span_pair<_Ty> & parts, const _Ty value)
+	{
+		std::size_t const result{ find((const _Ty*)parts.first.data(), parts.first.size(), value) };
+		if (result != parts.first.size())
+			return result;
+
+		return result + find((const _Ty*)parts.second.data(), parts.second.size(), value);
+	}
+
+	// 'output' receives 'parts.size()' values in logical order
+	template<typename _Ty>
+	inline void scale(const cyclic_span_pair<_Ty> & parts, const float factor, float * output)
+	{
+		scale((const _Ty*)parts.first.data(), parts.first.size(), factor, output);
+		scale((const _Ty*)parts.second.data(), parts.second.size(), factor, output + parts.first.size());
+	}
+}
+
+#endif // !_CYCLIC_KERNELS_H_
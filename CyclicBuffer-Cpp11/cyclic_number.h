@@ -3,37 +3,334 @@
 
 #include <assert.h>
 #include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <utility>
 
-template<typename _Ty>
-class cyclic_number
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace cyclic_number_detail
+{
+	// one past the largest '_Ty' modulo 2^64: 2^bits of an unsigned type, 0 for 64 bits
+	template<typename _Ty>
+	inline constexpr uint64_t full_width()
+	{
+		return (uint64_t)std::numeric_limits<_Ty>::max() + 1;
+	}
+
+	inline uint64_t mulhi(const uint64_t a, const uint64_t b)
+	{
+#if defined(__SIZEOF_INT128__)
+		return (uint64_t)(((unsigned __int128)a * b) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return __umulh(a, b);
+#else
+		uint64_t const a_lo{ (uint32_t)a }, a_hi{ a >> 32 };
+		uint64_t const b_lo{ (uint32_t)b }, b_hi{ b >> 32 };
+		uint64_t const cross{ (a_lo * b_lo >> 32) + (uint32_t)(a_hi * b_lo) + a_lo * b_hi };
+
+		return a_hi * b_hi + (a_hi * b_lo >> 32) + (cross >> 32);
+#endif
+	}
+
+	inline unsigned bit_width(uint64_t value)
+	{
+		unsigned result{ 0 };
+		for (/* nothing */; value != 0; value >>= 1)
+			++result;
+
+		return result;
+	}
+
+	// Reduction modulo a divisor fixed at run time, by multiplying with a precomputed
+	// reciprocal (Granlund-Montgomery, as in libdivide) instead of dividing. Powers of two
+	// are masked.
+	class divisor
+	{
+	private:
+		uint64_t divisor_;
+		uint64_t magic_;
+		unsigned shift_; // 0 for powers of two
+
+	public:
+		divisor(const uint64_t _divisor) :
+			divisor_{ _divisor },
+			magic_{ 0 },
+			shift_{ 0 }
+		{
+			if ((_divisor & (_divisor - 1)) == 0)
+				return;
+
+			// magic = floor(2^64 * (2^l - d) / d) + 1, with l = ceil(log2(d))
+			unsigned const l{ bit_width(_divisor - 1) };
+			uint64_t remainder{ l == 64 ? (uint64_t)0 - _divisor : ((uint64_t)1 << l) - _divisor };
+#if defined(__SIZEOF_INT128__)
+			magic_ = (uint64_t)(((unsigned __int128)remainder << 64) / _divisor) + 1;
+#else
+			uint64_t quotient{ 0 };
+
+			for (unsigned i = 0; i < 64; ++i)
+			{
+				bool const carry{ (remainder >> 63) != 0 };
+				remainder <<= 1;
+				quotient <<= 1;
+
+				if (carry || (remainder >= _divisor))
+				{
+					remainder -= _divisor;
+					quotient |= 1;
+				}
+			}
+
+			magic_ = quotient + 1;
+#endif
+			shift_ = l - 1;
+		}
+
+		inline uint64_t value() const
+		{
+			return divisor_;
+		}
+
+		inline uint64_t remainder(const uint64_t number) const
+		{
+			if (shift_ == 0)
+				return number & (divisor_ - 1);
+
+			uint64_t const high{ mulhi(magic_, number) };
+			uint64_t const quotient{ (high + ((number - high) >> 1)) >> shift_ };
+
+			return number - quotient * divisor_;
+		}
+	};
+
+	// modulus fixed at compile time: nothing is stored and the compiler turns the
+	// remainder into a mask or a multiplication
+	template<typename _Ty, uint64_t _Modulus>
+	class static_modulus
+	{
+	private:
+		static constexpr uint64_t maximum_{ _Modulus - 1 };
+
+		static_assert(_Modulus > 1, "Error: 'cyclic_number' modulus must be greater than 1.");
+		static_assert((maximum_ < full_width<_Ty>() - 1) || ((maximum_ == full_width<_Ty>() - 1) && std::is_unsigned<_Ty>::value), "Error: 'cyclic_number' modulus does not fit its type.");
+
+	public:
+		static constexpr bool is_static{ true };
+		static constexpr bool is_power_of_two{ (maximum_ & (maximum_ + 1)) == 0 };
+
+		static_modulus(const _Ty & _modulus = modulus())
+		{
+			assert(_modulus == modulus() /* Error: 'cyclic_number' modulus differs from its template argument. */);
+			(void)_modulus;
+		}
+
+		// 0 for 2^bits of '_Ty'
+		static inline constexpr _Ty modulus()
+		{
+			return (_Ty)(maximum_ + 1);
+		}
+
+		static inline constexpr uint64_t maximum()
+		{
+			return maximum_;
+		}
+
+	protected:
+		inline bool same_modulus_(const static_modulus &) const
+		{
+			return true;
+		}
+
+		static inline uint64_t remainder_(const uint64_t number)
+		{
+			return (is_power_of_two ? number & maximum_ : number % (maximum_ + 1));
+		}
+	};
+
+	// modulus of 2^bits of an unsigned '_Ty', which '_Modulus' can not spell for 64 bits:
+	// nothing is stored and every operation wraps like the plain integer
+	template<typename _Ty>
+	class full_width_modulus
+	{
+		static_assert(std::is_unsigned<_Ty>::value, "Error: 'cyclic_number' full width needs an unsigned type.");
+
+	public:
+		static constexpr bool is_static{ true };
+		static constexpr bool is_power_of_two{ true };
+
+		full_width_modulus(const _Ty & _modulus = modulus())
+		{
+			assert(_modulus == modulus() /* Error: 'cyclic_number' modulus differs from its template argument. */);
+			(void)_modulus;
+		}
+
+		// always 0
+		static inline constexpr _Ty modulus()
+		{
+			return (_Ty)0;
+		}
+
+		static inline constexpr uint64_t maximum()
+		{
+			return full_width<_Ty>() - 1;
+		}
+
+	protected:
+		inline bool same_modulus_(const full_width_modulus &) const
+		{
+			return true;
+		}
+
+		static inline uint64_t remainder_(const uint64_t number)
+		{
+			return number & maximum();
+		}
+	};
+
+	// modulus given at run time, with its divisor kept in every number
+	template<typename _Ty>
+	class dynamic_modulus
+	{
+	private:
+		divisor divisor_;
+
+	public:
+		static constexpr bool is_static{ false };
+
+		// 0 stands for 2^bits of an unsigned '_Ty'
+		dynamic_modulus(const _Ty & _modulus) :
+			divisor_{ _modulus == (_Ty)0 ? full_width<_Ty>() : (uint64_t)_modulus }
+		{
+			assert((_modulus > (_Ty)1) || ((_modulus == (_Ty)0) && std::is_unsigned<_Ty>::value) /* Error: 'cyclic_number' modulus must be greater than 1. */);
+		}
+
+		inline _Ty modulus() const
+		{
+			return (_Ty)divisor_.value();
+		}
+
+		inline uint64_t maximum() const
+		{
+			return divisor_.value() - 1;
+		}
+
+	protected:
+		inline bool same_modulus_(const dynamic_modulus & other) const
+		{
+			return (divisor_.value() == other.divisor_.value());
+		}
+
+		inline uint64_t remainder_(const uint64_t number) const
+		{
+			return (number < divisor_.value() ? number : divisor_.remainder(number));
+		}
+	};
+
+	// modulus of a divisor owned elsewhere, e.g. by a container holding several numbers of
+	// the same modulus; the divisor must outlive every number referring to it
+	template<typename _Ty>
+	class shared_modulus
+	{
+	private:
+		const divisor * divisor_;
+
+	public:
+		static constexpr bool is_static{ false };
+
+		shared_modulus(const divisor & _divisor) :
+			divisor_{ &_divisor }
+		{
+			assert((_divisor.value() != (uint64_t)1) && (_divisor.value() - 1 <= full_width<_Ty>() - 1) /* Error: 'cyclic_number' modulus does not fit its type. */);
+		}
+
+		inline _Ty modulus() const
+		{
+			return (_Ty)divisor_->value();
+		}
+
+		inline uint64_t maximum() const
+		{
+			return divisor_->value() - 1;
+		}
+
+	protected:
+		inline bool same_modulus_(const shared_modulus & other) const
+		{
+			return (divisor_->value() == other.divisor_->value());
+		}
+
+		inline uint64_t remainder_(const uint64_t number) const
+		{
+			return (number < divisor_->value() ? number : divisor_->remainder(number));
+		}
+	};
+
+	template<typename _Ty, uint64_t _Modulus>
+	using modulus_base = typename std::conditional<_Modulus == 0, shared_modulus<_Ty>, static_modulus<_Ty, _Modulus>>::type;
+}
+
+// Integer in [0, modulus). A non-zero '_Modulus' fixes the modulus at compile time and
+// leaves a single integer per object. Otherwise the modulus is given at run time as a
+// 'cyclic_number_detail::divisor' that the numbers of that modulus point to, so each
+// holds only its value and a pointer; '_Base' 'cyclic_number_detail::dynamic_modulus'
+// keeps a private divisor in every number instead. Every operation is constant time.
+// An unsigned type can use its whole range: '_Modulus' 2^bits, '_Base'
+// 'cyclic_number_detail::full_width_modulus' (see 'cyclic_full_width_number'), a divisor
+// of 2^bits or a 'dynamic_modulus' of 0 makes every operation wrap like the plain integer
+// and 'modulus' report 0.
+template<typename _Ty, uint64_t _Modulus = 0, class _Base = cyclic_number_detail::modulus_base<_Ty, _Modulus>>
+class cyclic_number : public _Base
 {
 	static_assert(std::is_integral<_Ty>::value, "Error: 'cyclic_number' type must be integral.");
 	static_assert(!std::is_const<_Ty>::value, "Error: 'cyclic_number' type can not be const.");
 	static_assert(!std::is_volatile<_Ty>::value, "Error: 'cyclic_number' type can not be volatile.");
 	static_assert(!std::is_reference<_Ty>::value, "Error: 'cyclic_number' type can not be reference.");
+	static_assert(sizeof(_Ty) <= sizeof(uint64_t), "Error: 'cyclic_number' type can not be wider than 64 bits.");
 
 public:
 	typedef _Ty value_type;
-	typedef cyclic_number<_Ty> type;
+	typedef cyclic_number<_Ty, _Modulus, _Base> type;
+	typedef _Base base_type;
+
+	using base_type::modulus;
 
 protected:
 	value_type value_;
-	value_type const modulus_;
 
 public:
+	// 'dynamic_modulus' and compile-time moduli
 	cyclic_number(value_type const & _value, value_type const & _modulus) :
-		value_{ _value },
-		modulus_{ _modulus }
+		base_type{ _modulus },
+		value_{ _value }
 	{
-		assert(_modulus > (value_type)1 /* Error: 'cyclic_number' modulus must be greater than 1. */);
 		assert(validate(_value, _modulus));
 	}
 
+	// run-time modulus shared through '_divisor'
+	cyclic_number(value_type const & _value, cyclic_number_detail::divisor const & _divisor) :
+		base_type{ _divisor },
+		value_{ _value }
+	{
+		assert(validate(_value, modulus()));
+	}
+
+	// compile-time modulus only
+	explicit cyclic_number(value_type const & _value = (value_type)0) :
+		value_{ _value }
+	{
+		static_assert(base_type::is_static, "Error: 'cyclic_number' needs a modulus.");
+		assert(validate(_value, modulus()));
+	}
+
+	cyclic_number(type const & other) = default;
+
 	type & operator=(type const & other)
 	{
-		assert(other.modulus_ == modulus_);
-		assert(validate(other.value_, modulus_));
+		assert(this->same_modulus_(other));
+		assert(validate(other.value_, modulus()));
 
 		value_ = other.value_;
 
@@ -47,33 +344,62 @@ public:
 
 	inline void value(value_type const & _value)
 	{
-		assert(validate(_value, modulus_));
+		assert(validate(_value, modulus()));
 
 		value_ = _value;
 	}
 
 	inline bool operator==(type const & other) const
 	{
-		assert(other.modulus_ == modulus_);
-		assert(validate(other.value_, modulus_));
+		assert(this->same_modulus_(other));
 
 		return (value_ == other.value_);
 	}
 
 	inline bool operator!=(type const & other) const
 	{
-		assert(other.modulus_ == modulus_);
-		assert(validate(other.value_, modulus_));
+		assert(this->same_modulus_(other));
 
 		return (value_ != other.value_);
 	}
 
-	inline type & operator++()
+	// RFC 1982 serial order: 'other' is greater when it lies less than half the modulus
+	// clockwise; two numbers exactly half the modulus apart are unordered
+	inline bool operator<(type const & other) const
+	{
+		assert(this->same_modulus_(other));
+
+		return ahead_(value_, other.value_);
+	}
+
+	inline bool operator>(type const & other) const
+	{
+		assert(this->same_modulus_(other));
+
+		return ahead_(other.value_, value_);
+	}
+
+	inline bool operator<=(type const & other) const
 	{
-		++value_;
+		return (value_ == other.value_) || operator<(other);
+	}
 
-		if (value_ >= modulus_)
-			value_ -= modulus_;
+	inline bool operator>=(type const & other) const
+	{
+		return (value_ == other.value_) || operator>(other);
+	}
+
+	// true when the two are closer than half the modulus, i.e. ordered or equal
+	inline bool within_half(type const & other) const
+	{
+		assert(this->same_modulus_(other));
+
+		return ((uint64_t)minimum_distance(other) <= this->maximum() / 2);
+	}
+
+	inline type & operator++()
+	{
+		add_(1);
 
 		return *this;
 	}
@@ -88,10 +414,7 @@ public:
 
 	inline type & operator--()
 	{
-		if (value_ < (value_type)1)
-			value_ += modulus_;
-
-		--value_;
+		subtract_(1);
 
 		return *this;
 	}
@@ -106,26 +429,20 @@ public:
 
 	inline type & operator+=(value_type const & number)
 	{
-		value_ += number;
-
-		while (value_ >= modulus_)
-			value_ -= modulus_;
-
-		while (value_ < (value_type)0)
-			value_ += modulus_;
+		if (number < (value_type)0)
+			subtract_(this->remainder_(magnitude_(number)));
+		else
+			add_(this->remainder_((uint64_t)number));
 
 		return *this;
 	}
 
 	inline type & operator-=(value_type const & number)
 	{
-		while (value_ < number)
-			value_ += modulus_;
-
-		value_ -= number;
-
-		while (value_ >= modulus_)
-			value_ -= modulus_;
+		if (number < (value_type)0)
+			add_(this->remainder_(magnitude_(number)));
+		else
+			subtract_(this->remainder_((uint64_t)number));
 
 		return *this;
 	}
@@ -148,54 +465,99 @@ public:
 
 	inline value_type clockwise_distance(type const & other) const
 	{
-		assert(other.modulus_ == modulus_);
-		assert(validate(other.value_, modulus_));
-
-		if (value_ <= other.value_)
-			return (value_type)(other.value_ - value_);
+		assert(this->same_modulus_(other));
 
-		return (value_type)((modulus_ + other.value_) - value_);
+		return distance_(value_, other.value_);
 	}
 
 	inline value_type counter_clockwise_distance(type const & other) const
 	{
-		assert(other.modulus_ == modulus_);
-		assert(validate(other.value_, modulus_));
+		assert(this->same_modulus_(other));
+
+		return distance_(other.value_, value_);
+	}
+
+	// the same against a plain value below the modulus, without building a number for it
+	inline value_type clockwise_distance(value_type const & other) const
+	{
+		assert(validate(other, modulus()));
 
-		if (other.value_ <= value_)
-			return (value_type)(value_ - other.value_);
+		return distance_(value_, other);
+	}
 
-		return (value_type)((modulus_ + value_) - other.value_);
+	inline value_type counter_clockwise_distance(value_type const & other) const
+	{
+		assert(validate(other, modulus()));
+
+		return distance_(other, value_);
 	}
 
 	inline value_type minimum_distance(type const & other) const
 	{
-		assert(other.modulus_ == modulus_);
-		assert(validate(other.value_, modulus_));
+		assert(this->same_modulus_(other));
 
 		value_type && distance_1{ (other.value_ >= value_) ? (value_type)(other.value_ - value_) : (value_type)(value_ - other.value_) };
-		value_type && distance_2{ (value_type)(modulus_ - distance_1) };
+		value_type && distance_2{ (value_type)(this->maximum() - (uint64_t)distance_1 + 1) };
 
 		return (distance_1 <= distance_2 ? distance_1 : distance_2);
 	}
 
+	// a 'modulus' of 0 is the full width of the type
 	static inline bool validate(value_type const & value, value_type const & modulus)
 	{
-		return ((value >= (value_type)0) && (value < modulus));
+		return ((value >= (value_type)0) && ((modulus == (value_type)0) || (value < modulus)));
 	}
 
 	static inline value_type normalize(value_type const & value, value_type const & modulus)
 	{
-		value_type result{ value };
+		if (modulus == (value_type)0)
+			return value;
 
-		while (result >= modulus)
-			result -= modulus;
+		value_type const result{ (value_type)(value % modulus) };
 
-		while (result < (value_type)0)
-			result += modulus;
+		return (result < (value_type)0 ? (value_type)(result + modulus) : result);
+	}
 
-		return result;
+private:
+	static inline uint64_t magnitude_(value_type const & number)
+	{
+		return (uint64_t)0 - (uint64_t)(int64_t)number;
+	}
+
+	// 'number' is below the modulus; written in terms of the largest value so that nothing
+	// overflows near the type's limit, and a 64-bit full width wraps like the integer
+	inline void add_(uint64_t const number)
+	{
+		uint64_t const room{ this->maximum() - number + 1 };
+		uint64_t const value{ (uint64_t)value_ };
+
+		value_ = (value_type)(value >= room ? value - room : value + number);
+	}
+
+	inline void subtract_(uint64_t const number)
+	{
+		uint64_t const value{ (uint64_t)value_ };
+
+		value_ = (value_type)(value >= number ? value - number : value + (this->maximum() - number + 1));
+	}
+
+	// 'to' lies 1 to (modulus - 1) / 2 steps clockwise of 'from'; a distance of 0 wraps
+	// around and fails the single compare
+	inline bool ahead_(value_type const & from, value_type const & to) const
+	{
+		return ((uint64_t)distance_(from, to) - 1 < this->maximum() / 2);
+	}
+
+	inline value_type distance_(value_type const & from, value_type const & to) const
+	{
+		uint64_t const wrap{ from > to ? this->maximum() + 1 : (uint64_t)0 };
+
+		return (value_type)((uint64_t)to - (uint64_t)from + wrap);
 	}
 };
 
+// 2^bits of an unsigned '_Ty', e.g. a 64-bit sequence number
+template<typename _Ty>
+using cyclic_full_width_number = cyclic_number<_Ty, 0, cyclic_number_detail::full_width_modulus<_Ty>>;
+
 #endif // !_CYCLIC_NUMBER_H_
@@ -0,0 +1,259 @@
+#ifndef _CYCLIC_QUANTILE_H_
+#define _CYCLIC_QUANTILE_H_
+
+#include <type_traits>
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "cyclic_buffer.h"
+
+// Sliding window with order statistics: next to the window itself every value lives in a
+// treap ordered by value and augmented with subtree sizes. A push inserts the new value
+// and erases the one evicted by 'force_push_back', both O(log N) expected; 'select' and
+// 'quantile' walk down one path. Nodes come from a fixed pool sized to the window.
+template<typename _Ty>
+class cyclic_quantile
+{
+	static_assert(!std::is_const<_Ty>::value, "Error: 'cyclic_quantile' type can not be const.");
+	static_assert(!std::is_volatile<_Ty>::value, "Error: 'cyclic_quantile' type can not be volatile.");
+	static_assert(!std::is_reference<_Ty>::value, "Error: 'cyclic_quantile' type can not be reference.");
+
+public:
+	typedef _Ty value_type;
+	typedef cyclic_quantile<_Ty> type;
+
+private:
+	typedef uint32_t node_t;
+
+	struct node
+	{
+		value_type value;
+		node_t left;
+		node_t right;
+		node_t size;
+		uint32_t priority;
+	};
+
+	cyclic_buffer_unsafe<value_type> values;
+
+	node * const nodes; // nodes[0] is the empty tree
+	node_t root;
+	node_t free_list;
+	uint32_t seed;
+
+public:
+	cyclic_quantile(type const &) = delete;
+	type & operator=(type const &) = delete;
+
+	cyclic_quantile(const std::size_t _capacity) :
+		values{ _capacity },
+		nodes{ (node*)malloc((_capacity + 1) * sizeof(node)) }
+	{
+		assert(_capacity < (std::size_t)UINT32_MAX /* Error: 'cyclic_quantile' capacity is too large. */);
+
+		seed = 0x9E3779B9u;
+		clear();
+	}
+
+	~cyclic_quantile()
+	{
+		free(nodes);
+	}
+
+	inline void push(value_type const & _value)
+	{
+		if (values.get_size() == values.get_capacity())
+			erase_(values.force_push_back(_value));
+		else
+			values.force_push_back(_value);
+
+		insert_(_value);
+	}
+
+	inline void clear()
+	{
+		while (values.get_size() > 0)
+			values.pop_front();
+
+		nodes[0].left = nodes[0].right = nodes[0].size = 0;
+		root = 0;
+
+		// every other node starts on the free list, chained through 'left'
+		free_list = 1;
+		for (std::size_t i = 1; i <= values.get_capacity(); ++i)
+			nodes[i].left = (i == values.get_capacity() ? 0 : (node_t)(i + 1));
+	}
+
+	// the '_rank'-th smallest value, 0 based
+	inline value_type select(std::size_t _rank) const
+	{
+		assert(_rank < values.get_size());
+
+		node_t it{ root };
+		for (;;)
+		{
+			std::size_t const left_size{ nodes[nodes[it].left].size };
+
+			if (_rank < left_size)
+				it = nodes[it].left;
+			else if (_rank == left_size)
+				return nodes[it].value;
+			else
+			{
+				_rank -= left_size + 1;
+				it = nodes[it].right;
+			}
+		}
+	}
+
+	// nearest-rank quantile: the smallest value with at least 'q' of the window at or below it
+	inline value_type quantile(const double q) const
+	{
+		assert((q >= 0.0) && (q <= 1.0));
+		assert(values.get_size() > (std::size_t)0);
+
+		double const exact{ q * (double)values.get_size() };
+		std::size_t rank{ (std::size_t)exact };
+		if ((double)rank < exact)
+			++rank;
+
+		return select(rank == 0 ? 0 : rank - 1);
+	}
+
+	// number of values strictly below '_value'
+	inline std::size_t rank(value_type const & _value) const
+	{
+		std::size_t result{ 0 };
+
+		for (node_t it = root; it != 0; /* nothing */)
+		{
+			if (nodes[it].value < _value)
+			{
+				result += nodes[nodes[it].left].size + 1;
+				it = nodes[it].right;
+			}
+			else
+				it = nodes[it].left;
+		}
+
+		return result;
+	}
+
+	inline const cyclic_buffer_unsafe<value_type> & get_values() const
+	{
+		return values;
+	}
+
+	inline std::size_t get_capacity() const
+	{
+		return values.get_capacity();
+	}
+
+	inline std::size_t get_size() const
+	{
+		return values.get_size();
+	}
+
+private:
+	inline void update_(const node_t it)
+	{
+		nodes[it].size = nodes[nodes[it].left].size + nodes[nodes[it].right].size + 1;
+	}
+
+	// 'less' receives the values below '_value', 'rest' the others
+	inline void split_(const node_t it, value_type const & _value, node_t & less, node_t & rest)
+	{
+		if (it == 0)
+		{
+			less = rest = 0;
+			return;
+		}
+
+		if (nodes[it].value < _value)
+		{
+			split_(nodes[it].right, _value, nodes[it].right, rest);
+			less = it;
+		}
+		else
+		{
+			split_(nodes[it].left, _value, less, nodes[it].left);
+			rest = it;
+		}
+
+		update_(it);
+	}
+
+	inline node_t merge_(const node_t left, const node_t right)
+	{
+		if ((left == 0) || (right == 0))
+			return left | right;
+
+		if (nodes[left].priority > nodes[right].priority)
+		{
+			nodes[left].right = merge_(nodes[left].right, right);
+			update_(left);
+
+			return left;
+		}
+
+		nodes[right].left = merge_(left, nodes[right].left);
+		update_(right);
+
+		return right;
+	}
+
+	// descends by priority to where the new node belongs and splits only the subtree below
+	inline void insert_(value_type const & _value)
+	{
+		node_t const fresh{ free_list };
+		assert(fresh != 0);
+		free_list = nodes[fresh].left;
+
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		nodes[fresh].value = _value;
+		nodes[fresh].priority = seed;
+
+		node_t * link{ &root };
+		while ((*link != 0) && (nodes[*link].priority > seed))
+		{
+			++nodes[*link].size;
+			link = (_value < nodes[*link].value ? &nodes[*link].left : &nodes[*link].right);
+		}
+
+		split_(*link, _value, nodes[fresh].left, nodes[fresh].right);
+		update_(fresh);
+		*link = fresh;
+	}
+
+	// the value is known to be present, so every node on the search path loses one
+	inline void erase_(value_type const & _value)
+	{
+		node_t * link{ &root };
+		for (;;)
+		{
+			assert((*link != 0) /* Error: 'cyclic_quantile' evicted value is missing. */);
+
+			node & current{ nodes[*link] };
+			if (_value < current.value)
+				link = &current.left;
+			else if (current.value < _value)
+				link = &current.right;
+			else
+				break;
+
+			--current.size;
+		}
+
+		node_t const found{ *link };
+		*link = merge_(nodes[found].left, nodes[found].right);
+
+		nodes[found].left = free_list;
+		free_list = found;
+	}
+};
+
+#endif // !_CYCLIC_QUANTILE_H_
@@ -1,12 +1,19 @@
 #ifndef _CYCLIC_REASSEMBLER_H_
 #define _CYCLIC_REASSEMBLER_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <type_traits>
+#include <vector>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
+#include "bit_ops.h"
+#include "cyclic_kernels.h"
 #include "cyclic_number.h"
+#include "cyclic_span.h"
 
 template<typename _Ty>
 class cyclic_reassembler
@@ -19,20 +26,29 @@ public:
 	typedef _Ty value_type;
 	typedef cyclic_reassembler<_Ty> type;
 
+	friend struct cyclic_snapshot_access;
+
 protected:
 	typedef cyclic_number<std::size_t> index_t;
 
 	const std::size_t modulus_;
 	const std::size_t size_;
 
+	// shared by the indices below, which keeps each of them two words
+	const cyclic_number_detail::divisor size_divisor_;
+	const cyclic_number_detail::divisor modulus_divisor_;
+
 	index_t read_point_; // base on size_
 	index_t offset_; // base on modulus_
 
 	value_type * const data_;
-	bool * const exist_;
+	uint64_t * const exist_; // presence bitmap, one bit per slot
+	const std::size_t words_;
+	const bool owner_; // data_ and exist_ were allocated here
+	mutable std::size_t present_; // bits set in exist_
 
 	bool closing{ false };
-	std::condition_variable_any cv;
+	std::atomic<std::condition_variable_any*> cv{ nullptr }; // made by the first blocking push
 
 public:
 	cyclic_reassembler(const type &) = delete;
@@ -41,16 +57,43 @@ public:
 	cyclic_reassembler(const std::size_t & _modulus, const std::size_t & _size) :
 		modulus_{ _modulus },
 		size_{ _size },
-		read_point_{ 0, _size },
-		offset_{ 0, _modulus },
+		size_divisor_{ _size },
+		modulus_divisor_{ _modulus },
+		read_point_{ 0, size_divisor_ },
+		offset_{ 0, modulus_divisor_ },
 		data_{ (value_type*)malloc(_size * sizeof(value_type)) },
-		exist_{ (bool*)malloc(_size * sizeof(bool)) }
+		exist_{ (uint64_t*)malloc(bit_ops::word_count(_size) * sizeof(uint64_t)) },
+		words_{ bit_ops::word_count(_size) },
+		owner_{ true },
+		present_{ 0 }
+	{
+		assert(_modulus > (std::size_t)1 /* Error: 'cyclic_reassembler' modulus must be greater than 1. */);
+		assert(_size > (std::size_t)1 /* Error: 'cyclic_reassembler' size must be greater than 1. */);
+		assert(_modulus >= _size /* Error: 'cyclic_reassembler' modulus must be greater than or equla to its size. */);
+
+		memset(exist_, 0, words_ * sizeof(uint64_t));
+	}
+
+	// window over caller-owned memory: '_data' holds '_size' values and '_exist'
+	// 'bit_ops::word_count(_size)' words; neither is freed here
+	cyclic_reassembler(const std::size_t & _modulus, const std::size_t & _size, value_type * const _data, uint64_t * const _exist) :
+		modulus_{ _modulus },
+		size_{ _size },
+		size_divisor_{ _size },
+		modulus_divisor_{ _modulus },
+		read_point_{ 0, size_divisor_ },
+		offset_{ 0, modulus_divisor_ },
+		data_{ _data },
+		exist_{ _exist },
+		words_{ bit_ops::word_count(_size) },
+		owner_{ false },
+		present_{ 0 }
 	{
 		assert(_modulus > (std::size_t)1 /* Error: 'cyclic_reassembler' modulus must be greater than 1. */);
 		assert(_size > (std::size_t)1 /* Error: 'cyclic_reassembler' size must be greater than 1. */);
 		assert(_modulus >= _size /* Error: 'cyclic_reassembler' modulus must be greater than or equla to its size. */);
 
-		memset(exist_, 0, _size * sizeof(bool));
+		memset(exist_, 0, words_ * sizeof(uint64_t));
 	}
 
 	cyclic_reassembler(const std::size_t & _modulus) :
@@ -59,11 +102,16 @@ public:
 
 	virtual ~cyclic_reassembler()
 	{
-		free(data_);
-		free(exist_);
+		if (owner_)
+		{
+			free(data_);
+			free(exist_);
+		}
 
 		closing = true;
-		cv.notify_all();
+		notify_();
+
+		delete cv.load();
 	}
 
 	inline value_type * begin() const
@@ -91,24 +139,38 @@ public:
 		return offset_.value();
 	}
 
+	// moves the window start to '_offset' in O(min(distance, size) / 64); a jump of a
+	// whole window or more empties it
 	inline void offset(const std::size_t & _offset)
 	{
 		assert(index_t::validate(_offset, modulus_));
 
-		for (/* nothing */; offset_.value() != _offset; ++offset_)
+		std::size_t const distance{ offset_.clockwise_distance(_offset) };
+		if (distance == 0)
+			return;
+
+		if (distance >= size_)
+		{
+			memset(exist_, 0, words_ * sizeof(uint64_t));
+			present_ = 0;
+			read_point_.value(0);
+		}
+		else
 		{
-			exist_[read_point_.value()] = false;
-			++read_point_;
+			clear_(read_point_.value(), distance);
+			read_point_ += distance;
 		}
 
-		cv.notify_all();
+		offset_.value(_offset);
+
+		notify_();
 	}
 
 	inline bool valid_index(std::size_t const & _index) const
 	{
 		assert(index_t::validate(_index, modulus_));
 
-		return (offset_.clockwise_distance(index_t(_index, modulus_)) < size_);
+		return (offset_.clockwise_distance(_index) < size_);
 	}
 
 	inline bool exist(std::size_t const & _index) const
@@ -116,35 +178,95 @@ public:
 		if (!valid_index(_index))
 			return false;
 
-		return exist_[local_index_(_index).value()];
+		return bit_ops::test(exist_, local_index_(_index).value());
 	}
 
-	inline void clear() const
+	// burst form of 'valid_index' for a header batch: bit i of '_valid'
+	// ('bit_ops::word_count(_count)' words) is set when '_indices[i]' lies inside the
+	// window; returns the number of bits set
+	inline std::size_t valid_index(const std::size_t * _indices, const std::size_t & _count, uint64_t * _valid) const
 	{
-		memset(exist_, 0, size_ * sizeof(bool));
+		return cyclic_kernels::within_window(_indices, _count, offset_.value(), modulus_, size_, _valid);
 	}
 
-	inline std::size_t ready_count() const
+	// as above, also dropping indices already pushed and repeats inside the burst, of which
+	// the first is kept: what is left can be pushed once each. '_scratch' holds
+	// 'bit_ops::word_count(size())' words and is overwritten with the slots kept.
+	inline std::size_t fresh_index(const std::size_t * _indices, const std::size_t & _count, uint64_t * _fresh, uint64_t * _scratch) const
 	{
-		std::size_t result{ 0 };
-		index_t it{ read_point_ };
-		while (exist_[it.value()])
+		std::size_t result{ valid_index(_indices, _count, _fresh) };
+		memset(_scratch, 0, words_ * sizeof(uint64_t));
+
+		for (std::size_t word = 0; word < bit_ops::word_count(_count); ++word)
 		{
-			++result;
-			if (++it == read_point_)
-				break;
+			for (uint64_t bits = _fresh[word]; bits != 0; bits &= bits - 1)
+			{
+				std::size_t const i{ word * bit_ops::word_bits + bit_ops::count_trailing_zeros(bits) };
+				std::size_t const slot{ local_index_(_indices[i]).value() };
+
+				if (bit_ops::test(exist_, slot) || bit_ops::test(_scratch, slot))
+				{
+					bit_ops::reset(_fresh, i);
+					--result;
+				}
+				else
+					bit_ops::set(_scratch, slot);
+			}
 		}
 
 		return result;
 	}
 
+	// the same with scratch on the stack, or on the heap for windows over 4096 slots
+	inline std::size_t fresh_index(const std::size_t * _indices, const std::size_t & _count, uint64_t * _fresh) const
+	{
+		uint64_t local[64];
+		if (words_ <= 64)
+			return fresh_index(_indices, _count, _fresh, local);
+
+		std::vector<uint64_t> scratch(words_);
+
+		return fresh_index(_indices, _count, _fresh, scratch.data());
+	}
+
+	inline void clear() const
+	{
+		memset(exist_, 0, words_ * sizeof(uint64_t));
+		present_ = 0;
+	}
+
+	// elements pushed and not popped yet, in order or not
+	inline std::size_t present_count() const
+	{
+		return present_;
+	}
+
+	inline std::size_t ready_count() const
+	{
+		std::size_t const start{ read_point_.value() };
+		std::size_t const result{ bit_ops::count_ones(exist_, start, size_ - start) };
+
+		if ((result < size_ - start) || (start == 0))
+			return result;
+
+		return result + bit_ops::count_ones(exist_, 0, start);
+	}
+
+	// the first index at or after 'offset' not pushed yet; 'offset + size' when the
+	// whole window is present
+	inline std::size_t next_missing() const
+	{
+		return (offset_ + ready_count()).value();
+	}
+
 	inline value_type push(value_type const & _value, std::size_t const & _index)
 	{
 		index_t local_index = local_index_(_index);
 
 		value_type result = data_[local_index.value()];
 		data_[local_index.value()] = _value;
-		exist_[local_index.value()] = true;
+		present_ += (bit_ops::test(exist_, local_index.value()) ? 0 : 1);
+		bit_ops::set(exist_, local_index.value());
 
 		return result;
 	}
@@ -154,16 +276,18 @@ public:
 	{
 		assert(index_t::validate(_index, modulus_));
 
-		index_t wrapped_index{ _index, modulus_ };
 		std::size_t diff{ 0 };
 
-		while (((diff = offset_.clockwise_distance(wrapped_index)) >= size_) && !closing)
-			cv.wait(lock);
+		while (((diff = offset_.clockwise_distance(_index)) >= size_) && !closing)
+		{
+			cv_()->wait(lock);
+		}
 
 		std::size_t local_index = (read_point_ + diff).value();
 		value_type result = data_[local_index];
 		data_[local_index] = _value;
-		exist_[local_index] = true;
+		present_ += (bit_ops::test(exist_, local_index) ? 0 : 1);
+		bit_ops::set(exist_, local_index);
 
 		return result;
 	}
@@ -172,7 +296,8 @@ public:
 	{
 		if (!valid_index(_index))
 		{
-			std::size_t && diff = offset_.clockwise_distance(index_t(_index, modulus_)) - (size_ - (std::size_t)1);
+			// '_index' becomes the last slot of the window
+			std::size_t && diff = offset_.clockwise_distance(_index) - (size_ - (std::size_t)1);
 			offset((offset_ + diff).value());
 		}
 
@@ -181,45 +306,110 @@ public:
 
 	inline value_type pop()
 	{
-		assert(exist_[read_point_.value()]);
+		assert(bit_ops::test(exist_, read_point_.value()));
 
 		value_type result = data_[read_point_.value()];
-		exist_[read_point_.value()] = false;
+		bit_ops::reset(exist_, read_point_.value());
+		--present_;
 
 		++read_point_;
 		++offset_;
 
-		cv.notify_all();
+		notify_();
 
 		return result;
 	}
 
 	inline value_type pop(const value_type & _value)
 	{
-		assert(exist_[read_point_.value()]);
+		assert(bit_ops::test(exist_, read_point_.value()));
 
 		value_type result = data_[read_point_.value()];
 		data_[read_point_.value()] = _value;
-		exist_[read_point_.value()] = false;
+		bit_ops::reset(exist_, read_point_.value());
+		--present_;
 
 		++read_point_;
 		++offset_;
 
-		cv.notify_all();
+		notify_();
+
+		return result;
+	}
+
+	// takes up to '_max' in-order ready elements at once: presence is cleared, the window
+	// advances and waiters are notified a single time. The spans point into the window and
+	// stay valid until those slots are pushed again.
+	inline cyclic_span_pair<value_type> pop_ready(const std::size_t & _max = (std::size_t)-1)
+	{
+		std::size_t const start{ read_point_.value() };
+		std::size_t const limit{ _max < size_ ? _max : size_ };
+
+		std::size_t const head{ bit_ops::count_ones(exist_, start, limit < size_ - start ? limit : size_ - start) };
+		std::size_t const tail{ (head == size_ - start) && (head < limit) ? bit_ops::count_ones(exist_, 0, limit - head) : 0 };
+
+		cyclic_span_pair<value_type> result;
+		result.first = cyclic_span<value_type>(data_ + start, head);
+		result.second = cyclic_span<value_type>(data_, tail);
+
+		if (head + tail > 0)
+		{
+			clear_(start, head + tail);
+			read_point_ += head + tail;
+			offset_ += head + tail;
+
+			notify_();
+		}
 
 		return result;
 	}
 
 protected:
+	// the first caller publishes the condition variable; a racing one drops its own
+	inline std::condition_variable_any * cv_()
+	{
+		std::condition_variable_any * result{ cv.load(std::memory_order_acquire) };
+		if (result != nullptr)
+			return result;
+
+		std::condition_variable_any * const fresh{ new std::condition_variable_any{} };
+		if (cv.compare_exchange_strong(result, fresh, std::memory_order_acq_rel))
+			return fresh;
+
+		delete fresh;
+
+		return result;
+	}
+
+	// safe from any thread; a wake-up still reaches a waiter only when the window is moved
+	// under the lock that its blocking 'push' holds
+	inline void notify_()
+	{
+		std::condition_variable_any * const current{ cv.load(std::memory_order_acquire) };
+		if (current != nullptr)
+			current->notify_all();
+	}
+
 	inline index_t local_index_(const std::size_t & _index) const
 	{
 		assert(index_t::validate(_index, modulus_));
 
-		std::size_t && diff = offset_.clockwise_distance(index_t{ _index, modulus_ });
+		std::size_t && diff = offset_.clockwise_distance(_index);
 		assert(diff < size_);
 
 		return (read_point_ + diff);
 	}
+
+	// clears 'count' presence bits from slot 'first' on, wrapping at 'size_'
+	inline void clear_(const std::size_t & first, const std::size_t & count)
+	{
+		std::size_t const head{ count < size_ - first ? count : size_ - first };
+
+		present_ -= bit_ops::count_set(exist_, first, head) + bit_ops::count_set(exist_, 0, count - head);
+
+		bit_ops::clear_range(exist_, first, head);
+		bit_ops::clear_range(exist_, 0, count - head);
+	}
 };
 
 #endif // !_CYCLIC_REASSEMBLER_H_
@@ -0,0 +1,225 @@
+#ifndef _CYCLIC_SNAPSHOT_H_
+#define _CYCLIC_SNAPSHOT_H_
+
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "bit_ops.h"
+#include "cyclic_span.h"
+#include "mapped_file.h"
+
+template<typename _Ty, bool _LockFree, bool _Recyclable>
+class cyclic_buffer;
+
+template<typename _Ty>
+class cyclic_reassembler;
+
+// On-disk image of a buffer: a fixed header, 'count' records in logical order and an
+// optional block of per-slot flags. Written and read back through a single mapping.
+class cyclic_snapshot
+{
+public:
+	struct header
+	{
+		uint32_t magic;
+		uint32_t value_size;
+		uint64_t capacity;
+		uint64_t count;
+		uint64_t modulus;
+		uint64_t offset;
+		uint64_t start; // slot of the first record when the records are stored unrotated
+		uint64_t flags_size;
+	};
+
+	typedef std::pair<const void*, std::size_t> chunk;
+
+	static constexpr uint32_t magic_number{ 0x53424359 }; // "YCBS"
+
+private:
+	mapped_file file;
+
+public:
+	cyclic_snapshot(const cyclic_snapshot&) = delete;
+	cyclic_snapshot& operator=(const cyclic_snapshot&) = delete;
+
+	cyclic_snapshot() = default;
+
+	// 'chunks' are concatenated after the header: records first, then flags
+	static inline bool write(const std::string & path, header _header, std::initializer_list<chunk> chunks)
+	{
+		_header.magic = magic_number;
+
+		std::size_t total{ sizeof(header) };
+		for (const chunk & it : chunks)
+			total += it.second;
+
+		mapped_file target;
+		if (!target.create(path, total))
+			return false;
+
+		char * it{ (char*)target.data() };
+		memcpy(it, &_header, sizeof(header));
+		it += sizeof(header);
+
+		for (const chunk & part : chunks)
+		{
+			if (part.second > 0)
+				memcpy(it, part.first, part.second);
+
+			it += part.second;
+		}
+
+		return target.flush();
+	}
+
+	inline bool open(const std::string & path, const std::size_t & value_size)
+	{
+		if (!file.open(path))
+			return false;
+
+		if ((file.size() < sizeof(header)) ||
+			(get_header().magic != magic_number) ||
+			(get_header().value_size != value_size) ||
+			(file.size() != sizeof(header) + get_header().count * value_size + get_header().flags_size))
+		{
+			file.close();
+			return false;
+		}
+
+		return true;
+	}
+
+	inline const header & get_header() const
+	{
+		return *(const header*)file.data();
+	}
+
+	inline const void * records() const
+	{
+		return (const char*)file.data() + sizeof(header);
+	}
+
+	inline const void * flags() const
+	{
+		return (const char*)records() + get_header().count * get_header().value_size;
+	}
+};
+
+// Reaches into the containers, which befriend it, so that their own headers stay free of
+// file and OS headers; use it through the functions below.
+struct cyclic_snapshot_access
+{
+	template<class _Buffer>
+	static inline bool save_buffer(const _Buffer & buffer, const std::string & path)
+	{
+		typedef typename _Buffer::value_type value_type;
+		static_assert(std::is_trivially_copyable<value_type>::value, "Error: 'cyclic_buffer' snapshot type must be trivially copyable.");
+
+		cyclic_span_pair<value_type> const parts{ buffer.snapshot_segments_() };
+
+		cyclic_snapshot::header image{};
+		image.value_size = sizeof(value_type);
+		image.capacity = buffer.get_capacity();
+		image.count = parts.size();
+
+		return cyclic_snapshot::write(path, image, {
+			cyclic_snapshot::chunk(parts.first.data(), parts.first.size() * sizeof(value_type)),
+			cyclic_snapshot::chunk(parts.second.data(), parts.second.size() * sizeof(value_type)) });
+	}
+
+	template<class _Buffer>
+	static inline bool load_buffer(_Buffer & buffer, const std::string & path)
+	{
+		typedef typename _Buffer::value_type value_type;
+		static_assert(std::is_trivially_copyable<value_type>::value, "Error: 'cyclic_buffer' snapshot type must be trivially copyable.");
+		assert(buffer.get_size() == 0 /* Error: 'cyclic_buffer' snapshot restored into a non-empty buffer. */);
+
+		cyclic_snapshot image;
+		if (!image.open(path, sizeof(value_type)) || (image.get_header().count > buffer.get_capacity()))
+			return false;
+
+		buffer.restore_((const value_type*)image.records(), (std::size_t)image.get_header().count);
+
+		return true;
+	}
+
+	template<typename _Ty>
+	static inline bool save_window(const cyclic_reassembler<_Ty> & window, const std::string & path)
+	{
+		static_assert(std::is_trivially_copyable<_Ty>::value, "Error: 'cyclic_reassembler' snapshot type must be trivially copyable.");
+
+		cyclic_snapshot::header image{};
+		image.value_size = sizeof(_Ty);
+		image.capacity = window.size_;
+		image.count = window.size_;
+		image.modulus = window.modulus_;
+		image.offset = window.offset_.value();
+		image.start = window.read_point_.value();
+		image.flags_size = window.words_ * sizeof(uint64_t);
+
+		return cyclic_snapshot::write(path, image, {
+			cyclic_snapshot::chunk(window.data_, window.size_ * sizeof(_Ty)),
+			cyclic_snapshot::chunk(window.exist_, window.words_ * sizeof(uint64_t)) });
+	}
+
+	template<typename _Ty>
+	static inline bool load_window(cyclic_reassembler<_Ty> & window, const std::string & path)
+	{
+		static_assert(std::is_trivially_copyable<_Ty>::value, "Error: 'cyclic_reassembler' snapshot type must be trivially copyable.");
+
+		cyclic_snapshot image;
+		if (!image.open(path, sizeof(_Ty)) ||
+			(image.get_header().modulus != window.modulus_) ||
+			(image.get_header().count != window.size_) ||
+			(image.get_header().offset >= window.modulus_) ||
+			(image.get_header().start >= window.size_) ||
+			(image.get_header().flags_size != window.words_ * sizeof(uint64_t)))
+			return false;
+
+		memcpy(window.data_, image.records(), window.size_ * sizeof(_Ty));
+		memcpy(window.exist_, image.flags(), window.words_ * sizeof(uint64_t));
+		window.present_ = bit_ops::count_set(window.exist_, 0, window.size_);
+		window.read_point_.value((std::size_t)image.get_header().start);
+		window.offset_.value((std::size_t)image.get_header().offset);
+
+		return true;
+	}
+};
+
+// writes the queued elements in order; producers and consumers must be quiescent
+template<typename _Ty, bool _LockFree, bool _Recyclable>
+inline bool save_snapshot(const cyclic_buffer<_Ty, _LockFree, _Recyclable> & buffer, const std::string & path)
+{
+	return cyclic_snapshot_access::save_buffer(buffer, path);
+}
+
+// refills an empty buffer; false, leaving it empty, when 'path' holds no snapshot of this
+// type or more elements than the buffer's capacity
+template<typename _Ty, bool _LockFree, bool _Recyclable>
+inline bool load_snapshot(cyclic_buffer<_Ty, _LockFree, _Recyclable> & buffer, const std::string & path)
+{
+	return cyclic_snapshot_access::load_buffer(buffer, path);
+}
+
+// writes the whole window and its presence bitmap as they lie in memory; no producer or
+// consumer may run meanwhile
+template<typename _Ty>
+inline bool save_snapshot(const cyclic_reassembler<_Ty> & window, const std::string & path)
+{
+	return cyclic_snapshot_access::save_window(window, path);
+}
+
+// replaces the window's contents with a snapshot of the same modulus and size; false,
+// leaving the window untouched, when 'path' holds none
+template<typename _Ty>
+inline bool load_snapshot(cyclic_reassembler<_Ty> & window, const std::string & path)
+{
+	return cyclic_snapshot_access::load_window(window, path);
+}
+
+#endif // !_CYCLIC_SNAPSHOT_H_
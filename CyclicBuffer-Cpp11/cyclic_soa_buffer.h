@@ -0,0 +1,189 @@
+#ifndef _CYCLIC_SOA_BUFFER_H_
+#define _CYCLIC_SOA_BUFFER_H_
+
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "cyclic_span.h"
+
+// Single threaded ring of records stored as one contiguous column per field, all sharing
+// the same cursors. Scanning a column through 'column<N>()' touches that field only.
+template<typename... _Fields>
+class cyclic_soa_buffer
+{
+	static_assert(sizeof...(_Fields) > 0, "Error: 'cyclic_soa_buffer' needs at least one field.");
+	static_assert(std::is_same<std::integer_sequence<bool, true, std::is_trivially_copyable<_Fields>::value...>, std::integer_sequence<bool, std::is_trivially_copyable<_Fields>::value..., true>>::value, "Error: 'cyclic_soa_buffer' fields must be trivially copyable.");
+	static_assert(std::is_same<std::integer_sequence<bool, true, !std::is_const<_Fields>::value...>, std::integer_sequence<bool, !std::is_const<_Fields>::value..., true>>::value, "Error: 'cyclic_soa_buffer' fields can not be const.");
+
+public:
+	typedef std::tuple<_Fields...> value_type;
+	typedef cyclic_soa_buffer<_Fields...> type;
+	static constexpr std::size_t column_count{ sizeof...(_Fields) };
+
+	template<std::size_t _Column>
+	using column_type = typename std::tuple_element<_Column, value_type>::type;
+
+private:
+	typedef std::index_sequence_for<_Fields...> columns_t;
+
+	std::tuple<_Fields*...> columns;
+
+	std::size_t front_point;
+	std::size_t back_point;
+
+	std::size_t size;
+	const std::size_t capacity;
+
+public:
+	cyclic_soa_buffer(type const &) = delete;
+	type & operator=(type const &) = delete;
+
+	cyclic_soa_buffer(const std::size_t _capacity) :
+		columns{ (_Fields*)malloc(_capacity * sizeof(_Fields))... },
+		capacity{ _capacity }
+	{
+		assert(_capacity > (std::size_t)1);
+
+		front_point = back_point = 0;
+		size = 0;
+	}
+
+	~cyclic_soa_buffer()
+	{
+		free_(columns_t{});
+	}
+
+	inline void push_back(_Fields const &... _values)
+	{
+		assert(size < capacity);
+
+		store_(back_point, columns_t{}, _values...);
+
+		(back_point == capacity - 1 ? back_point = 0 : ++back_point);
+		++size;
+	}
+
+	inline void push_back(value_type const & _row)
+	{
+		assert(size < capacity);
+
+		store_(back_point, columns_t{}, _row);
+
+		(back_point == capacity - 1 ? back_point = 0 : ++back_point);
+		++size;
+	}
+
+	// overwrites the oldest row when full
+	inline void force_push_back(_Fields const &... _values)
+	{
+		store_(back_point, columns_t{}, _values...);
+
+		(back_point == capacity - 1 ? back_point = 0 : ++back_point);
+		if (size == capacity)
+			front_point = back_point;
+		else
+			++size;
+	}
+
+	inline value_type pop_front()
+	{
+		assert(size > (std::size_t)0);
+
+		value_type result{ load_(front_point, columns_t{}) };
+
+		(front_point == capacity - 1 ? front_point = 0 : ++front_point);
+		--size;
+
+		return result;
+	}
+
+	inline void drop_front(const std::size_t & count = 1)
+	{
+		assert(count <= size);
+
+		front_point += count;
+		if (front_point >= capacity)
+			front_point -= capacity;
+
+		size -= count;
+	}
+
+	inline value_type operator[](const std::size_t & _index) const
+	{
+		return load_(slot_(_index), columns_t{});
+	}
+
+	template<std::size_t _Column>
+	inline column_type<_Column> & at(const std::size_t & _index) const
+	{
+		return std::get<_Column>(columns)[slot_(_index)];
+	}
+
+	// the queued values of one field, oldest first, as at most two contiguous runs
+	template<std::size_t _Column>
+	inline cyclic_span_pair<column_type<_Column>> column() const
+	{
+		column_type<_Column> * const base{ std::get<_Column>(columns) };
+		std::size_t const first{ (capacity - front_point < size ? capacity - front_point : size) };
+
+		cyclic_span_pair<column_type<_Column>> result;
+		result.first = cyclic_span<column_type<_Column>>(base + front_point, first);
+		result.second = cyclic_span<column_type<_Column>>(base, size - first);
+
+		return result;
+	}
+
+	template<std::size_t _Column>
+	inline column_type<_Column> * column_data() const
+	{
+		return std::get<_Column>(columns);
+	}
+
+	inline std::size_t get_capacity() const
+	{
+		return capacity;
+	}
+
+	inline std::size_t get_size() const
+	{
+		return size;
+	}
+
+private:
+	inline std::size_t slot_(const std::size_t & _index) const
+	{
+		assert(_index < size);
+
+		return (_index < capacity - front_point ? front_point + _index : _index - (capacity - front_point));
+	}
+
+	template<std::size_t... _Columns>
+	inline void store_(const std::size_t & slot, std::index_sequence<_Columns...>, _Fields const &... _values)
+	{
+		(void)std::initializer_list<int>{ (std::get<_Columns>(columns)[slot] = _values, 0)... };
+	}
+
+	template<std::size_t... _Columns>
+	inline void store_(const std::size_t & slot, std::index_sequence<_Columns...>, value_type const & _row)
+	{
+		(void)std::initializer_list<int>{ (std::get<_Columns>(columns)[slot] = std::get<_Columns>(_row), 0)... };
+	}
+
+	template<std::size_t... _Columns>
+	inline value_type load_(const std::size_t & slot, std::index_sequence<_Columns...>) const
+	{
+		return value_type{ std::get<_Columns>(columns)[slot]... };
+	}
+
+	template<std::size_t... _Columns>
+	inline void free_(std::index_sequence<_Columns...>)
+	{
+		(void)std::initializer_list<int>{ (free(std::get<_Columns>(columns)), 0)... };
+	}
+};
+
+#endif // !_CYCLIC_SOA_BUFFER_H_
@@ -0,0 +1,85 @@
+#ifndef _CYCLIC_SPAN_H_
+#define _CYCLIC_SPAN_H_
+
+#include <cstddef>
+#include <assert.h>
+
+// Non-owning view of a contiguous run of elements; a wrapped ring region is exposed as a
+// 'cyclic_span_pair', oldest segment first.
+template<typename _Ty>
+class cyclic_span
+{
+public:
+	typedef _Ty value_type;
+
+private:
+	value_type * data_;
+	std::size_t size_;
+
+public:
+	cyclic_span() :
+		data_{ nullptr },
+		size_{ 0 }
+	{ }
+
+	cyclic_span(value_type * const _data, const std::size_t & _size) :
+		data_{ _data },
+		size_{ _size }
+	{ }
+
+	inline value_type * data() const
+	{
+		return data_;
+	}
+
+	inline std::size_t size() const
+	{
+		return size_;
+	}
+
+	inline bool empty() const
+	{
+		return (size_ == 0);
+	}
+
+	inline value_type * begin() const
+	{
+		return data_;
+	}
+
+	inline value_type * end() const
+	{
+		return data_ + size_;
+	}
+
+	inline value_type & operator[](const std::size_t & _index) const
+	{
+		assert(_index < size_);
+
+		return data_[_index];
+	}
+};
+
+template<typename _Ty>
+struct cyclic_span_pair
+{
+	cyclic_span<_Ty> first;
+	cyclic_span<_Ty> second;
+
+	inline std::size_t size() const
+	{
+		return first.size() + second.size();
+	}
+
+	inline bool empty() const
+	{
+		return first.empty() && second.empty();
+	}
+
+	inline _Ty & operator[](const std::size_t & _index) const
+	{
+		return (_index < first.size() ? first[_index] : second[_index - first.size()]);
+	}
+};
+
+#endif // !_CYCLIC_SPAN_H_
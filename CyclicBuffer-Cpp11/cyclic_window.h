@@ -0,0 +1,197 @@
+#ifndef _CYCLIC_WINDOW_H_
+#define _CYCLIC_WINDOW_H_
+
+#include <type_traits>
+#include <assert.h>
+
+#include "cyclic_buffer.h"
+
+// Fixed-length sliding window with O(1) aggregates: sum and sum of squares follow the
+// value entering and the one evicted by 'force_push_back', min and max come from
+// monotonic deques.
+//
+// Tolerance: between two resyncs every value is added and subtracted once, so the
+// running sum drifts from a full recompute by at most about
+// 2 * resync_period * epsilon(_Acc) * max|x| (max|x|^2 for the sum of squares).
+// The variance is derived from both sums and additionally loses relative precision
+// when the mean is large against the spread; resync more often in that case.
+template<typename _Ty, typename _Acc = double>
+class cyclic_window
+{
+	static_assert(std::is_arithmetic<_Ty>::value, "Error: 'cyclic_window' type must be arithmetic.");
+	static_assert(std::is_floating_point<_Acc>::value, "Error: 'cyclic_window' accumulator must be floating point.");
+
+public:
+	typedef _Ty value_type;
+	typedef _Acc accumulator_type;
+	typedef cyclic_window<_Ty, _Acc> type;
+
+private:
+	struct entry
+	{
+		value_type value;
+		std::size_t sequence;
+	};
+
+	cyclic_buffer_unsafe<value_type> values;
+	cyclic_buffer_unsafe<entry> minimums;
+	cyclic_buffer_unsafe<entry> maximums;
+
+	accumulator_type sum;
+	accumulator_type sum_squares;
+
+	std::size_t sequence;
+	const std::size_t resync_period;
+	std::size_t since_resync;
+
+public:
+	cyclic_window(type const &) = delete;
+	type & operator=(type const &) = delete;
+
+	// the sums are recomputed from the window every '_resync_period' pushes (0 never)
+	cyclic_window(const std::size_t _capacity, const std::size_t _resync_period = 0) :
+		values{ _capacity },
+		minimums{ _capacity },
+		maximums{ _capacity },
+		resync_period{ _resync_period == 0 ? (std::size_t)-1 : _resync_period }
+	{
+		sum = sum_squares = 0;
+		sequence = since_resync = 0;
+	}
+
+	inline void push(value_type const & _value)
+	{
+		accumulator_type const entering{ (accumulator_type)_value };
+
+		if (values.get_size() == values.get_capacity())
+		{
+			accumulator_type const leaving{ (accumulator_type)values.force_push_back(_value) };
+			sum -= leaving;
+			sum_squares -= leaving * leaving;
+		}
+		else
+			values.force_push_back(_value);
+
+		sum += entering;
+		sum_squares += entering * entering;
+
+		if (sequence >= values.get_capacity())
+		{
+			std::size_t const expired{ sequence - values.get_capacity() };
+
+			if ((minimums.get_size() > 0) && (minimums[0].sequence == expired))
+				minimums.pop_front();
+
+			if ((maximums.get_size() > 0) && (maximums[0].sequence == expired))
+				maximums.pop_front();
+		}
+
+		while ((minimums.get_size() > 0) && !(minimums[minimums.get_size() - 1].value < _value))
+			minimums.pop_back();
+
+		while ((maximums.get_size() > 0) && !(_value < maximums[maximums.get_size() - 1].value))
+			maximums.pop_back();
+
+		minimums.push_back(entry{ _value, sequence });
+		maximums.push_back(entry{ _value, sequence });
+		++sequence;
+
+		if (++since_resync == resync_period)
+			resync();
+	}
+
+	// recomputes the sums from the stored values
+	inline void resync()
+	{
+		cyclic_span_pair<value_type> const parts{ values.segments() };
+
+		sum = sum_squares = 0;
+		for (value_type const & it : parts.first)
+		{
+			sum += (accumulator_type)it;
+			sum_squares += (accumulator_type)it * (accumulator_type)it;
+		}
+
+		for (value_type const & it : parts.second)
+		{
+			sum += (accumulator_type)it;
+			sum_squares += (accumulator_type)it * (accumulator_type)it;
+		}
+
+		since_resync = 0;
+	}
+
+	inline void clear()
+	{
+		while (values.get_size() > 0)
+			values.pop_front();
+
+		while (minimums.get_size() > 0)
+			minimums.pop_front();
+
+		while (maximums.get_size() > 0)
+			maximums.pop_front();
+
+		sum = sum_squares = 0;
+		sequence = since_resync = 0;
+	}
+
+	inline accumulator_type get_sum() const
+	{
+		return sum;
+	}
+
+	inline accumulator_type get_sum_squares() const
+	{
+		return sum_squares;
+	}
+
+	inline accumulator_type get_mean() const
+	{
+		assert(values.get_size() > (std::size_t)0);
+
+		return sum / (accumulator_type)values.get_size();
+	}
+
+	// population variance
+	inline accumulator_type get_variance() const
+	{
+		assert(values.get_size() > (std::size_t)0);
+
+		accumulator_type const count{ (accumulator_type)values.get_size() };
+		accumulator_type const result{ (sum_squares - sum * sum / count) / count };
+
+		return (result < 0 ? (accumulator_type)0 : result);
+	}
+
+	inline value_type get_min() const
+	{
+		assert(minimums.get_size() > (std::size_t)0);
+
+		return minimums[0].value;
+	}
+
+	inline value_type get_max() const
+	{
+		assert(maximums.get_size() > (std::size_t)0);
+
+		return maximums[0].value;
+	}
+
+	inline const cyclic_buffer_unsafe<value_type> & get_values() const
+	{
+		return values;
+	}
+
+	inline std::size_t get_capacity() const
+	{
+		return values.get_capacity();
+	}
+
+	inline std::size_t get_size() const
+	{
+		return values.get_size();
+	}
+};
+
+#endif // !_CYCLIC_WINDOW_H_
@@ -0,0 +1,137 @@
+#ifndef _LOSSY_REASSEMBLER_H_
+#define _LOSSY_REASSEMBLER_H_
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "cyclic_reassembler.h"
+
+// Reassembler that gives up on lost indices: once the hole at the window start has been
+// seen by the consumer for longer than 'gap_timeout', or the window holds at least
+// 'fill_threshold' of its size, the hole is skipped in one step. Skipped indices are
+// collected as [begin, end) ranges (modulus-wrapped, adjacent ones merged) for NACKs.
+template<typename _Ty>
+class lossy_reassembler : public cyclic_reassembler<_Ty>
+{
+public:
+	typedef _Ty value_type;
+	typedef lossy_reassembler<_Ty> type;
+	typedef cyclic_reassembler<_Ty> base_type;
+	typedef std::chrono::steady_clock clock_type;
+	typedef std::pair<std::size_t, std::size_t> range_type;
+
+private:
+	const clock_type::duration gap_timeout;
+	const std::size_t fill_limit;
+
+	bool gap_open;
+	std::size_t gap_offset;
+	clock_type::time_point gap_since;
+
+	std::vector<range_type> missing;
+	std::size_t skipped;
+
+public:
+	lossy_reassembler(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	// '_fill_threshold' is a fraction of '_size'; at 1 a hole is skipped only once every
+	// other slot of the window is filled
+	lossy_reassembler(const std::size_t & _modulus, const std::size_t & _size, const clock_type::duration & _gap_timeout, const double _fill_threshold = 1.0) :
+		base_type{ _modulus, _size },
+		gap_timeout{ _gap_timeout },
+		fill_limit{ fill_limit_(_size, _fill_threshold) }
+	{
+		gap_open = false;
+		gap_offset = 0;
+		skipped = 0;
+	}
+
+	// skips the hole at the window start if it is due; returns the number of indices skipped
+	inline std::size_t skip_gap(const clock_type::time_point & now = clock_type::now())
+	{
+		std::size_t const start{ this->read_point_.value() };
+		if (bit_ops::test(this->exist_, start))
+		{
+			gap_open = false;
+			return 0;
+		}
+
+		std::size_t const present{ this->present_ };
+		if (present == 0)
+		{
+			// nothing behind the hole yet: idle, not lost
+			gap_open = false;
+			return 0;
+		}
+
+		if (!gap_open || (gap_offset != this->offset_.value()))
+		{
+			gap_open = true;
+			gap_offset = this->offset_.value();
+			gap_since = now;
+		}
+
+		if ((now - gap_since < gap_timeout) && (present < fill_limit))
+			return 0;
+
+		std::size_t length{ bit_ops::count_zeros(this->exist_, start, this->size_ - start) };
+		if ((length == this->size_ - start) && (start > 0))
+			length += bit_ops::count_zeros(this->exist_, 0, start);
+
+		std::size_t const begin{ this->offset_.value() };
+		std::size_t const end{ (this->offset_ + length).value() };
+
+		if (!missing.empty() && (missing.back().second == begin))
+			missing.back().second = end;
+		else
+			missing.push_back(range_type(begin, end));
+
+		skipped += length;
+		gap_open = false;
+
+		this->offset(end);
+
+		return length;
+	}
+
+	// 'cyclic_reassembler::pop_ready' after skipping a due hole
+	inline cyclic_span_pair<value_type> pop_ready(const std::size_t & _max = (std::size_t)-1, const clock_type::time_point & now = clock_type::now())
+	{
+		skip_gap(now);
+
+		return base_type::pop_ready(_max);
+	}
+
+	// hands over the skipped ranges collected so far
+	inline void take_missing(std::vector<range_type> & ranges)
+	{
+		ranges.clear();
+		ranges.swap(missing);
+	}
+
+	inline const std::vector<range_type> & get_missing() const
+	{
+		return missing;
+	}
+
+	inline std::size_t get_skipped() const
+	{
+		return skipped;
+	}
+
+private:
+	static inline std::size_t fill_limit_(const std::size_t & _size, const double _fill_threshold)
+	{
+		// the hole itself is never present
+		if (_fill_threshold >= 1.0)
+			return _size - 1;
+
+		std::size_t const result{ (std::size_t)(_fill_threshold * (double)_size) };
+
+		return (result == 0 ? 1 : (result > _size - 1 ? _size - 1 : result));
+	}
+};
+
+#endif // !_LOSSY_REASSEMBLER_H_
@@ -0,0 +1,205 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <string>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Whole-file read/write memory mapping; every call reports failure through its result.
+class mapped_file
+{
+private:
+	void * data_;
+	std::size_t size_;
+
+#ifdef _WIN32
+	HANDLE file_;
+	HANDLE mapping_;
+#else
+	int file_;
+#endif
+
+public:
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	mapped_file() :
+		data_{ nullptr },
+		size_{ 0 },
+#ifdef _WIN32
+		file_{ INVALID_HANDLE_VALUE },
+		mapping_{ NULL }
+#else
+		file_{ -1 }
+#endif
+	{ }
+
+	~mapped_file()
+	{
+		close();
+	}
+
+	inline bool is_open() const
+	{
+		return (data_ != nullptr);
+	}
+
+	inline void * data() const
+	{
+		return data_;
+	}
+
+	inline std::size_t size() const
+	{
+		return size_;
+	}
+
+	// creates (or truncates) the file to '_size' bytes and maps it
+	inline bool create(const std::string & path, const std::size_t & _size)
+	{
+		close();
+
+#ifdef _WIN32
+		file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file_ == INVALID_HANDLE_VALUE)
+			return false;
+#else
+		file_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (file_ < 0)
+			return false;
+
+		if (ftruncate(file_, (off_t)_size) != 0)
+		{
+			close();
+			return false;
+		}
+#endif
+
+		return map_(_size, true);
+	}
+
+	// maps an existing file as a whole
+	inline bool open(const std::string & path, const bool writable = false)
+	{
+		close();
+
+#ifdef _WIN32
+		file_ = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file_ == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file_, &file_size) || (file_size.QuadPart == 0))
+		{
+			close();
+			return false;
+		}
+
+		return map_((std::size_t)file_size.QuadPart, writable);
+#else
+		file_ = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+		if (file_ < 0)
+			return false;
+
+		struct stat file_stat;
+		if ((fstat(file_, &file_stat) != 0) || (file_stat.st_size == 0))
+		{
+			close();
+			return false;
+		}
+
+		return map_((std::size_t)file_stat.st_size, writable);
+#endif
+	}
+
+	inline bool flush()
+	{
+		if (data_ == nullptr)
+			return false;
+
+#ifdef _WIN32
+		return (FlushViewOfFile(data_, size_) != FALSE);
+#else
+		return (msync(data_, size_, MS_SYNC) == 0);
+#endif
+	}
+
+	inline void close()
+	{
+#ifdef _WIN32
+		if (data_ != nullptr)
+			UnmapViewOfFile(data_);
+
+		if (mapping_ != NULL)
+			CloseHandle(mapping_);
+
+		if (file_ != INVALID_HANDLE_VALUE)
+			CloseHandle(file_);
+
+		mapping_ = NULL;
+		file_ = INVALID_HANDLE_VALUE;
+#else
+		if (data_ != nullptr)
+			munmap(data_, size_);
+
+		if (file_ >= 0)
+			::close(file_);
+
+		file_ = -1;
+#endif
+
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	static inline bool remove(const std::string & path)
+	{
+		return (::remove(path.c_str()) == 0);
+	}
+
+private:
+	inline bool map_(const std::size_t & _size, const bool writable)
+	{
+#ifdef _WIN32
+		mapping_ = CreateFileMappingA(file_, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, (DWORD)((unsigned long long)_size >> 32), (DWORD)(_size & 0xFFFFFFFFull), NULL);
+		if (mapping_ == NULL)
+		{
+			close();
+			return false;
+		}
+
+		data_ = MapViewOfFile(mapping_, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, _size);
+#else
+		data_ = mmap(nullptr, _size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, file_, 0);
+		if (data_ == MAP_FAILED)
+			data_ = nullptr;
+#endif
+
+		if (data_ == nullptr)
+		{
+			close();
+			return false;
+		}
+
+		size_ = _size;
+
+		return true;
+	}
+};
+
+#endif // !_MAPPED_FILE_H_
@@ -0,0 +1,218 @@
+#ifndef _ORDERED_PARALLEL_MAP_H_
+#define _ORDERED_PARALLEL_MAP_H_
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <stddef.h>
+#include <assert.h>
+
+#include "basic_cyclic_buffer.h"
+#include "concurrent_reassembler.h"
+
+// Applies 'transform' on a pool of worker threads and hands the results out in submission
+// order. 'submit' numbers every input and waits while 'window' inputs are in flight, i.e.
+// submitted but not yet popped; the input queue and the reassembler are both one window
+// long, so a worker never waits for room and a slow element stalls at most one window.
+// A window of a few times the thread count absorbs uneven per-element cost.
+template<typename _In, typename _Out>
+class ordered_parallel_map
+{
+	static_assert(!std::is_reference<_In>::value, "Error: 'ordered_parallel_map' input type can not be reference.");
+	static_assert(!std::is_reference<_Out>::value, "Error: 'ordered_parallel_map' output type can not be reference.");
+
+public:
+	typedef _In input_type;
+	typedef _Out output_type;
+	typedef ordered_parallel_map<_In, _Out> type;
+	typedef std::function<_Out(const _In&)> transform_type;
+
+private:
+	struct job
+	{
+		std::size_t sequence;
+		input_type value;
+	};
+
+	typedef basic_cyclic_buffer<job, cyclic_policy::mpmc, cyclic_policy::block> input_buffer;
+	typedef concurrent_reassembler<output_type> output_buffer;
+
+	const std::size_t window;
+	const transform_type transform;
+
+	input_buffer input;
+	output_buffer output;
+
+	std::atomic<std::size_t> submitted;
+	std::atomic<std::size_t> delivered;
+	std::atomic<std::size_t> running;
+	std::atomic<std::size_t> submitting; // 'submit' calls that may still push
+	std::atomic<bool> closed;
+	mutable cyclic_policy::park_wait credit_waiter;
+
+	std::vector<std::thread> workers;
+
+public:
+	ordered_parallel_map(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	ordered_parallel_map(const std::size_t & _threads, const std::size_t & _window, transform_type _transform) :
+		window{ _window },
+		transform{ std::move(_transform) },
+		input{ _window },
+		output{ _window }
+	{
+		assert(_threads > (std::size_t)0 /* Error: 'ordered_parallel_map' needs at least one worker. */);
+		assert(_window >= _threads /* Error: 'ordered_parallel_map' window must be at least the thread count. */);
+
+		submitted = 0;
+		delivered = 0;
+		running = _threads;
+		submitting = 0;
+		closed = false;
+
+		workers.reserve(_threads);
+		for (std::size_t i = 0; i < _threads; ++i)
+			workers.emplace_back(&type::work_, this);
+	}
+
+	~ordered_parallel_map()
+	{
+		close();
+		output.terminate();
+		credit_waiter.notify();
+
+		for (auto & it : workers)
+			it.join();
+	}
+
+	inline std::size_t get_window() const
+	{
+		return window;
+	}
+
+	inline std::size_t get_threads() const
+	{
+		return workers.size();
+	}
+
+	inline std::size_t get_in_flight() const
+	{
+		return submitted.load(std::memory_order_relaxed) - delivered.load(std::memory_order_relaxed);
+	}
+
+	// waits while the window is full; false once closed. A sequence number is taken only
+	// together with its credit and only while open, so every number taken is pushed.
+	inline bool submit(const input_type & value)
+	{
+		submitting.fetch_add(1);
+
+		std::size_t sequence{ submitted.load() };
+		for (;;)
+		{
+			if (closed)
+			{
+				leave_();
+				return false;
+			}
+
+			if (sequence - delivered.load(std::memory_order_acquire) < window)
+			{
+				if (submitted.compare_exchange_weak(sequence, sequence + 1))
+					break;
+
+				continue;
+			}
+
+			credit_waiter.wait([this] { return (submitted.load() - delivered.load(std::memory_order_acquire) < window) || closed; });
+			sequence = submitted.load();
+		}
+
+		// within the window the input queue always has room
+		bool const result{ input.push(job{ sequence, value }) };
+		leave_();
+
+		return result;
+	}
+
+	// no more input: waits for 'submit' calls already past the check, then workers finish
+	// what was submitted and 'pop' reports the end
+	inline void close()
+	{
+		closed = true;
+		credit_waiter.notify();
+		credit_waiter.wait([this] { return submitting.load() == 0; });
+
+		input.terminate();
+	}
+
+	inline bool is_closed() const
+	{
+		return closed;
+	}
+
+	// waits for the next result in submission order; false once closed and drained
+	inline bool pop(output_type & value)
+	{
+		if (!output.pop(value))
+			return false;
+
+		release_(1);
+
+		return true;
+	}
+
+	inline bool try_pop(output_type & value)
+	{
+		if (!output.try_pop(value))
+			return false;
+
+		release_(1);
+
+		return true;
+	}
+
+	// hands every result that is ready in order to '_func' and frees their window slots at once
+	template<class _Func>
+	inline std::size_t consume_ready(_Func && _func)
+	{
+		std::size_t const result{ output.consume_ready((std::size_t)-1, std::forward<_Func>(_func)) };
+		if (result > 0)
+			release_(result);
+
+		return result;
+	}
+
+	inline void wait_for_data() const
+	{
+		output.wait_for_data();
+	}
+
+private:
+	inline void leave_()
+	{
+		submitting.fetch_sub(1);
+		credit_waiter.notify();
+	}
+
+	inline void release_(const std::size_t & count)
+	{
+		delivered.fetch_add(count, std::memory_order_release);
+		credit_waiter.notify();
+	}
+
+	inline void work_()
+	{
+		job item;
+		while (input.pop(item))
+			output.push(transform(item.value), item.sequence % window);
+
+		// the last worker out has pushed everything there is
+		if (running.fetch_sub(1) == 1)
+			output.terminate();
+	}
+};
+
+#endif // !_ORDERED_PARALLEL_MAP_H_
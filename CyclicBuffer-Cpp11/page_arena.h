@@ -0,0 +1,171 @@
+#ifndef _PAGE_ARENA_H_
+#define _PAGE_ARENA_H_
+
+#include <cstddef>
+#include <assert.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// One zero-filled, page-aligned region taken straight from the OS. Huge pages are tried
+// first (MAP_HUGETLB / MEM_LARGE_PAGES, which need reserved pages or a privilege) and are
+// committed whole for the arena's lifetime. Otherwise the range is only reserved: parts
+// are backed with 'commit' and handed back with 'decommit', reading as zero when committed
+// again. A normal mapping is hinted for transparent huge pages where the OS supports it.
+class page_arena
+{
+private:
+	void * data_;
+	std::size_t size_;
+	std::size_t page_;
+	bool huge_;
+
+public:
+	page_arena(const page_arena&) = delete;
+	page_arena& operator=(const page_arena&) = delete;
+
+	page_arena(const std::size_t & _size) :
+		data_{ nullptr },
+		size_{ 0 },
+		page_{ 0 },
+		huge_{ false }
+	{
+		if (_size == 0)
+			return;
+
+#ifdef _WIN32
+		SIZE_T const large{ GetLargePageMinimum() };
+		if (large != 0)
+		{
+			SIZE_T const rounded{ (_size + large - 1) / large * large };
+			data_ = VirtualAlloc(NULL, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (data_ != NULL)
+			{
+				size_ = rounded;
+				huge_ = true;
+				return;
+			}
+		}
+
+		data_ = VirtualAlloc(NULL, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (data_ != NULL)
+			size_ = _size;
+#else
+#ifdef MAP_HUGETLB
+		std::size_t const large{ (std::size_t)2 << 20 };
+		std::size_t const rounded{ (_size + large - 1) / large * large };
+		void * const huge{ mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) };
+		if (huge != MAP_FAILED)
+		{
+			data_ = huge;
+			size_ = rounded;
+			page_ = large;
+			huge_ = true;
+			return;
+		}
+#endif
+
+		// anonymous pages are backed on first touch, so reserving is mapping without swap
+		void * const normal{ mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0) };
+		if (normal == MAP_FAILED)
+			return;
+
+		data_ = normal;
+		size_ = _size;
+		page_ = (std::size_t)sysconf(_SC_PAGESIZE);
+#ifdef MADV_HUGEPAGE
+		madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+#endif
+	}
+
+	~page_arena()
+	{
+		if (data_ == nullptr)
+			return;
+
+#ifdef _WIN32
+		VirtualFree(data_, 0, MEM_RELEASE);
+#else
+		munmap(data_, size_);
+#endif
+	}
+
+	inline bool is_open() const
+	{
+		return (data_ != nullptr);
+	}
+
+	inline void * data() const
+	{
+		return data_;
+	}
+
+	// may exceed the requested size when rounded up to whole huge pages
+	inline std::size_t size() const
+	{
+		return size_;
+	}
+
+	inline bool is_huge() const
+	{
+		return huge_;
+	}
+
+	inline std::size_t page_size() const
+	{
+		return page_;
+	}
+
+	// backs every page touching ['_offset', '_offset' + '_length'); false when the OS is
+	// out of memory
+	inline bool commit(const std::size_t & _offset, const std::size_t & _length)
+	{
+		assert(_offset + _length <= size_);
+
+		if (huge_ || (_length == 0))
+			return true;
+
+#ifdef _WIN32
+		std::size_t const first{ _offset / page_ * page_ };
+		std::size_t const last{ (_offset + _length + page_ - 1) / page_ * page_ };
+
+		return (VirtualAlloc((char*)data_ + first, last - first, MEM_COMMIT, PAGE_READWRITE) != NULL);
+#else
+		return true;
+#endif
+	}
+
+	// gives back the pages lying wholly inside ['_offset', '_offset' + '_length'), leaving
+	// pages shared with a neighbouring range alone; huge pages stay
+	inline void decommit(const std::size_t & _offset, const std::size_t & _length)
+	{
+		assert(_offset + _length <= size_);
+
+		if (huge_)
+			return;
+
+		std::size_t const first{ (_offset + page_ - 1) / page_ * page_ };
+		std::size_t const last{ (_offset + _length) / page_ * page_ };
+		if (first >= last)
+			return;
+
+#ifdef _WIN32
+		VirtualFree((char*)data_ + first, last - first, MEM_DECOMMIT);
+#else
+		madvise((char*)data_ + first, last - first, MADV_DONTNEED);
+#endif
+	}
+};
+
+#endif // !_PAGE_ARENA_H_
@@ -0,0 +1,303 @@
+#ifndef _PAYLOAD_REASSEMBLER_H_
+#define _PAYLOAD_REASSEMBLER_H_
+
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "cyclic_reassembler.h"
+#include "cyclic_span.h"
+
+struct payload_view
+{
+	uint8_t * data;
+	std::size_t length;
+};
+
+// Reassembler for variable-length payloads stored in one byte ring tied to the window. A
+// producer 'reserve's room for an index (at most 'max_payload' bytes, rounded up to whole
+// cache lines), writes - or lets the NIC write - the payload in place and 'commit's its
+// length. Room is handed out from the ring head in arrival order and given back as the
+// window moves past its index, so the arena only has to hold what is in flight rather
+// than 'max_payload' per slot. Room freed out of arrival order is reused only once all
+// room reserved before it is freed too, so leave the arena some headroom; 'reserve' and
+// 'push' fail rather than overwrite when it is full. Views returned by 'pop' and
+// 'pop_ready' stay valid until the next call that is not const.
+class payload_reassembler : public cyclic_reassembler<payload_view>
+{
+public:
+	typedef payload_reassembler type;
+	typedef cyclic_reassembler<payload_view> base_type;
+
+private:
+	enum { cache_line = 64 };
+
+	static constexpr std::size_t npos{ (std::size_t)-1 };
+
+	// one reservation, in arena order; the arena is given back up to the first one still held
+	struct extent
+	{
+		uint64_t end;
+		bool released;
+	};
+
+	const std::size_t max_payload;
+	const std::size_t arena_size;
+	uint8_t * const arena;
+
+	uint64_t alloc_position; // arena bytes handed out so far, wrap padding included
+	uint64_t free_position; // arena bytes given back so far
+
+	const std::size_t extent_capacity;
+	extent * const extents;
+	uint64_t extent_head;
+	uint64_t extent_tail;
+
+	std::size_t * const slot_extent; // reservation held by each slot, 'npos' when none
+	std::vector<std::size_t> popped; // reservations behind the views of the last pop
+
+public:
+	payload_reassembler(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	// '_arena_size' defaults to 'max_payload' for every slot plus one for wrap padding
+	payload_reassembler(const std::size_t & _modulus, const std::size_t & _size, const std::size_t & _max_payload, const std::size_t & _arena_size = 0) :
+		base_type{ _modulus, _size },
+		max_payload{ _max_payload },
+		arena_size{ round_(_arena_size != 0 ? _arena_size : (_size + 1) * round_(_max_payload)) },
+		arena{ (uint8_t*)aligned_allocate_(round_(_arena_size != 0 ? _arena_size : (_size + 1) * round_(_max_payload))) },
+		extent_capacity{ 2 * _size },
+		extents{ (extent*)malloc(2 * _size * sizeof(extent)) },
+		slot_extent{ (std::size_t*)malloc(_size * sizeof(std::size_t)) }
+	{
+		assert(_max_payload > (std::size_t)0);
+		assert(round_(_max_payload) <= arena_size /* Error: 'payload_reassembler' arena can not hold one payload. */);
+
+		alloc_position = free_position = 0;
+		extent_head = extent_tail = 0;
+
+		for (std::size_t i = 0; i < _size; ++i)
+			slot_extent[i] = npos;
+
+		popped.reserve(_size);
+	}
+
+	~payload_reassembler()
+	{
+		aligned_free_(arena);
+		free(extents);
+		free(slot_extent);
+	}
+
+	using base_type::offset;
+
+	inline std::size_t get_max_payload() const
+	{
+		return max_payload;
+	}
+
+	inline std::size_t get_arena_size() const
+	{
+		return arena_size;
+	}
+
+	// arena bytes held by reservations, payloads and not yet released views
+	inline std::size_t get_arena_used() const
+	{
+		return (std::size_t)(alloc_position - free_position);
+	}
+
+	// writable room for '_index', which must be inside the window; empty when the arena is
+	// full or '_index' is already present. Reserving again replaces an uncommitted room.
+	inline cyclic_span<uint8_t> reserve(const std::size_t & _index, const std::size_t & _length)
+	{
+		assert(_length <= max_payload);
+
+		release_popped_();
+
+		std::size_t const slot{ local_index_(_index).value() };
+		if (bit_ops::test(exist_, slot))
+			return cyclic_span<uint8_t>();
+
+		release_slot_(slot);
+
+		uint8_t * const room{ allocate_(slot, round_(_length != 0 ? _length : 1)) };
+		if (room == nullptr)
+			return cyclic_span<uint8_t>();
+
+		data_[slot] = payload_view{ room, 0 };
+
+		return cyclic_span<uint8_t>(room, _length);
+	}
+
+	inline cyclic_span<uint8_t> reserve(const std::size_t & _index)
+	{
+		return reserve(_index, max_payload);
+	}
+
+	// marks '_index' present with the first '_length' bytes of its reserved room
+	inline void commit(const std::size_t & _index, const std::size_t & _length)
+	{
+		assert(_length <= max_payload);
+
+		std::size_t const slot{ local_index_(_index).value() };
+		assert(slot_extent[slot] != npos /* Error: 'payload_reassembler' commit without reserve. */);
+
+		base_type::push(payload_view{ data_[slot].data, _length }, _index);
+	}
+
+	// false when the arena is full or '_index' is already present
+	inline bool push(const void * _payload, const std::size_t & _length, const std::size_t & _index)
+	{
+		cyclic_span<uint8_t> const room{ reserve(_index, _length) };
+		if (room.data() == nullptr)
+			return false;
+
+		memcpy(room.data(), _payload, _length);
+		commit(_index, _length);
+
+		return true;
+	}
+
+	inline payload_view pop()
+	{
+		release_popped_();
+
+		std::size_t const slot{ read_point_.value() };
+		payload_view const result{ base_type::pop() };
+
+		popped.push_back(slot_extent[slot]);
+		slot_extent[slot] = npos;
+
+		return result;
+	}
+
+	inline cyclic_span_pair<payload_view> pop_ready(const std::size_t & _max = (std::size_t)-1)
+	{
+		release_popped_();
+
+		std::size_t const start{ read_point_.value() };
+		cyclic_span_pair<payload_view> const result{ base_type::pop_ready(_max) };
+
+		for (std::size_t i = 0, slot = start; i < result.size(); ++i, (slot == size_ - 1 ? slot = 0 : ++slot))
+		{
+			popped.push_back(slot_extent[slot]);
+			slot_extent[slot] = npos;
+		}
+
+		return result;
+	}
+
+	// moves the window start; the room of every skipped index is given back
+	inline void offset(const std::size_t & _offset)
+	{
+		release_popped_();
+
+		std::size_t distance{ offset_.clockwise_distance(_offset) };
+		if (distance > size_)
+			distance = size_;
+
+		for (std::size_t i = 0, slot = read_point_.value(); i < distance; ++i, (slot == size_ - 1 ? slot = 0 : ++slot))
+			release_slot_(slot);
+
+		base_type::offset(_offset);
+	}
+
+	inline void clear()
+	{
+		release_popped_();
+
+		for (std::size_t slot = 0; slot < size_; ++slot)
+			release_slot_(slot);
+
+		base_type::clear();
+	}
+
+private:
+	// these would bypass the arena bookkeeping
+	using base_type::force_push;
+
+	static inline std::size_t round_(const std::size_t & bytes)
+	{
+		return (bytes + cache_line - 1) / cache_line * cache_line;
+	}
+
+	static inline void * aligned_allocate_(const std::size_t & bytes)
+	{
+#ifdef _WIN32
+		return _aligned_malloc(bytes, cache_line);
+#else
+		void * result{ nullptr };
+
+		return (posix_memalign(&result, cache_line, bytes) == 0 ? result : nullptr);
+#endif
+	}
+
+	static inline void aligned_free_(void * memory)
+	{
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	}
+
+	inline uint8_t * allocate_(const std::size_t & slot, const std::size_t & bytes)
+	{
+		if (extent_tail - extent_head == extent_capacity)
+			return nullptr;
+
+		// a room never wraps: the rest of the arena is skipped as padding instead
+		uint64_t begin{ alloc_position };
+		std::size_t const inside{ (std::size_t)(begin % arena_size) };
+		if (inside + bytes > arena_size)
+			begin += arena_size - inside;
+
+		if (begin + bytes - free_position > arena_size)
+			return nullptr;
+
+		extents[extent_tail % extent_capacity] = extent{ begin + bytes, false };
+		slot_extent[slot] = (std::size_t)(extent_tail % extent_capacity);
+		++extent_tail;
+
+		alloc_position = begin + bytes;
+
+		return arena + (std::size_t)(begin % arena_size);
+	}
+
+	inline void release_(const std::size_t & reservation)
+	{
+		extents[reservation].released = true;
+
+		while ((extent_head != extent_tail) && extents[extent_head % extent_capacity].released)
+		{
+			free_position = extents[extent_head % extent_capacity].end;
+			++extent_head;
+		}
+	}
+
+	inline void release_slot_(const std::size_t & slot)
+	{
+		if (slot_extent[slot] == npos)
+			return;
+
+		release_(slot_extent[slot]);
+		slot_extent[slot] = npos;
+	}
+
+	inline void release_popped_()
+	{
+		for (std::size_t it : popped)
+			release_(it);
+
+		popped.clear();
+	}
+};
+
+#endif // !_PAYLOAD_REASSEMBLER_H_
@@ -0,0 +1,275 @@
+#ifndef _REASSEMBLER_TABLE_H_
+#define _REASSEMBLER_TABLE_H_
+
+#include <chrono>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "cyclic_reassembler.h"
+#include "page_arena.h"
+
+// Flow-keyed set of reassemblers sharing one arena. The arena is cut into 'max_windows'
+// equal blocks, each holding one window's values and presence bitmap; a flow takes a
+// block when it becomes active and gives it back when it is detached or idle for
+// 'idle_period'. Only the address range is reserved up front: a block is committed on
+// attach and its whole pages are decommitted on release, so memory follows the active
+// flows once a block spans a page or more. With huge pages the arena stays committed.
+template<typename _Ty, typename _Key = uint64_t, class _Hash = std::hash<_Key>>
+class reassembler_table
+{
+	static_assert(alignof(_Ty) <= 64, "Error: 'reassembler_table' type alignment can not exceed a cache line.");
+
+public:
+	typedef _Ty value_type;
+	typedef _Key key_type;
+	typedef reassembler_table<_Ty, _Key, _Hash> type;
+	typedef cyclic_reassembler<_Ty> window_type;
+	typedef std::chrono::steady_clock clock_type;
+
+	struct item
+	{
+		key_type key;
+		std::size_t index;
+		value_type value;
+	};
+
+private:
+	enum { cache_line = 64 };
+
+	struct flow
+	{
+		window_type * window;
+		std::size_t block;
+		clock_type::time_point last_used;
+	};
+
+	typedef typename std::aligned_storage<sizeof(window_type), alignof(window_type)>::type slot_type;
+
+	const std::size_t modulus_;
+	const std::size_t size_;
+	const std::size_t max_windows;
+	const clock_type::duration idle_period;
+
+	const std::size_t data_bytes; // values of one window, padded to a cache line
+	const std::size_t stride; // values and presence bitmap of one window
+
+	page_arena arena;
+	std::vector<slot_type> slots;
+	std::vector<std::size_t> free_blocks;
+	std::unordered_map<key_type, flow, _Hash> flows;
+
+	// 'push_batch' scratch: each flow's items of the burst as a list in arrival order
+	struct run
+	{
+		std::size_t first;
+		std::size_t last;
+	};
+
+	std::unordered_map<key_type, run, _Hash> runs;
+	std::vector<std::size_t> next;
+
+public:
+	reassembler_table(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	reassembler_table(const std::size_t & _modulus, const std::size_t & _size, const std::size_t & _max_windows, const clock_type::duration & _idle_period) :
+		modulus_{ _modulus },
+		size_{ _size },
+		max_windows{ _max_windows },
+		idle_period{ _idle_period },
+		data_bytes{ round_(_size * sizeof(value_type)) },
+		stride{ round_(_size * sizeof(value_type)) + round_(bit_ops::word_count(_size) * sizeof(uint64_t)) },
+		arena{ _max_windows * (round_(_size * sizeof(value_type)) + round_(bit_ops::word_count(_size) * sizeof(uint64_t))) },
+		slots(_max_windows)
+	{
+		assert(_max_windows > (std::size_t)0 /* Error: 'reassembler_table' must hold at least one window. */);
+		assert(arena.is_open() /* Error: 'reassembler_table' arena allocation failed. */);
+
+		free_blocks.reserve(max_windows);
+		for (std::size_t i = max_windows; i > 0; --i)
+			free_blocks.push_back(i - 1);
+
+		flows.reserve(max_windows);
+	}
+
+	~reassembler_table()
+	{
+		for (auto & it : flows)
+			it.second.window->~window_type();
+	}
+
+	inline std::size_t modulus() const
+	{
+		return modulus_;
+	}
+
+	inline std::size_t size() const
+	{
+		return size_;
+	}
+
+	inline std::size_t get_active() const
+	{
+		return flows.size();
+	}
+
+	inline std::size_t get_capacity() const
+	{
+		return max_windows;
+	}
+
+	inline bool is_huge() const
+	{
+		return arena.is_huge();
+	}
+
+	// the window of '_key', nullptr when it is not attached
+	inline window_type * find(const key_type & _key) const
+	{
+		auto const it = flows.find(_key);
+
+		return (it == flows.end() ? nullptr : it->second.window);
+	}
+
+	// the window of '_key', attaching an empty one starting at '_offset' if needed;
+	// nullptr when every block is taken
+	inline window_type * attach(const key_type & _key, const std::size_t & _offset = 0, const clock_type::time_point & now = clock_type::now())
+	{
+		flow * const result{ attach_(_key, _offset, now) };
+
+		return (result == nullptr ? nullptr : result->window);
+	}
+
+	// drops the window of '_key' and everything still buffered in it
+	inline bool detach(const key_type & _key)
+	{
+		auto const it = flows.find(_key);
+		if (it == flows.end())
+			return false;
+
+		release_(it->second);
+		flows.erase(it);
+
+		return true;
+	}
+
+	// an unknown flow is attached with its window starting at '_index'; false when
+	// '_index' is outside the window or no block is free
+	inline bool push(const key_type & _key, const std::size_t & _index, const value_type & _value, const clock_type::time_point & now = clock_type::now())
+	{
+		flow * const target{ attach_(_key, _index, now) };
+
+		return push_(target, _index, _value, now);
+	}
+
+	// pushes a burst with one flow lookup per key, each flow's items in arrival order;
+	// returns the items accepted
+	inline std::size_t push_batch(const item * _items, const std::size_t & _count, const clock_type::time_point & now = clock_type::now())
+	{
+		static constexpr std::size_t npos{ (std::size_t)-1 };
+
+		// group by key in one pass through a map no larger than the burst
+		runs.clear();
+		next.assign(_count, npos);
+
+		for (std::size_t i = 0; i < _count; ++i)
+		{
+			auto const it = runs.emplace(_items[i].key, run{ i, i });
+			if (it.second)
+				continue;
+
+			next[it.first->second.last] = i;
+			it.first->second.last = i;
+		}
+
+		std::size_t result{ 0 };
+
+		for (auto const & it : runs)
+		{
+			flow * const target{ attach_(it.first, _items[it.second.first].index, now) };
+
+			for (std::size_t i = it.second.first; i != npos; i = next[i])
+			{
+				if (push_(target, _items[i].index, _items[i].value, now))
+					++result;
+			}
+		}
+
+		return result;
+	}
+
+	// detaches every flow not pushed to for 'idle_period'; returns the number detached
+	inline std::size_t expire(const clock_type::time_point & now = clock_type::now())
+	{
+		std::size_t result{ 0 };
+
+		for (auto it = flows.begin(); it != flows.end(); /* nothing */)
+		{
+			if (now - it->second.last_used < idle_period)
+			{
+				++it;
+				continue;
+			}
+
+			release_(it->second);
+			it = flows.erase(it);
+			++result;
+		}
+
+		return result;
+	}
+
+private:
+	static inline std::size_t round_(const std::size_t & bytes)
+	{
+		return (bytes + cache_line - 1) / cache_line * cache_line;
+	}
+
+	inline flow * attach_(const key_type & _key, const std::size_t & _offset, const clock_type::time_point & now)
+	{
+		auto const it = flows.find(_key);
+		if (it != flows.end())
+			return &it->second;
+
+		if (free_blocks.empty())
+			return nullptr;
+
+		std::size_t const block{ free_blocks.back() };
+		if (!arena.commit(block * stride, stride))
+			return nullptr;
+
+		free_blocks.pop_back();
+
+		uint8_t * const base{ (uint8_t*)arena.data() + block * stride };
+		window_type * const window{ new (&slots[block]) window_type{ modulus_, size_, (value_type*)base, (uint64_t*)(base + data_bytes) } };
+		window->offset(_offset);
+
+		return &flows.emplace(_key, flow{ window, block, now }).first->second;
+	}
+
+	inline bool push_(flow * target, const std::size_t & _index, const value_type & _value, const clock_type::time_point & now)
+	{
+		if ((target == nullptr) || !target->window->valid_index(_index))
+			return false;
+
+		target->window->push(_value, _index);
+		target->last_used = now;
+
+		return true;
+	}
+
+	inline void release_(flow & target)
+	{
+		target.window->~window_type();
+		arena.decommit(target.block * stride, stride);
+		free_blocks.push_back(target.block);
+	}
+};
+
+#endif // !_REASSEMBLER_TABLE_H_
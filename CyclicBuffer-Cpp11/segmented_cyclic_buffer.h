@@ -0,0 +1,324 @@
+#ifndef _SEGMENTED_CYCLIC_BUFFER_H_
+#define _SEGMENTED_CYCLIC_BUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <type_traits>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "basic_cyclic_buffer.h"
+#include "spin_lock.h"
+
+// Single producer / single consumer queue that grows by linking fixed-size segments.
+// A full segment never blocks the producer: it links a pooled (or new) segment and
+// carries on; the consumer hands drained segments back to the pool, and pooled segments
+// left unused for 'idle_period' are freed.
+template<typename _Ty, class _Wait = cyclic_policy::park_wait>
+class segmented_cyclic_buffer
+{
+	static_assert(!std::is_const<_Ty>::value, "Error: 'segmented_cyclic_buffer' type can not be const.");
+	static_assert(!std::is_volatile<_Ty>::value, "Error: 'segmented_cyclic_buffer' type can not be volatile.");
+	static_assert(!std::is_reference<_Ty>::value, "Error: 'segmented_cyclic_buffer' type can not be reference.");
+
+public:
+	typedef _Ty value_type;
+	typedef segmented_cyclic_buffer<_Ty, _Wait> type;
+	typedef std::chrono::steady_clock clock_type;
+	static constexpr bool is_lock_free{ true };
+	static constexpr bool is_recyclable{ false };
+
+private:
+	struct segment
+	{
+		value_type * const values;
+		std::atomic<std::size_t> written;
+		std::atomic<segment*> next;
+
+		segment * pooled;
+		clock_type::time_point released;
+
+		segment(const std::size_t & _size) :
+			values{ (value_type*)malloc(_size * sizeof(value_type)) },
+			pooled{ nullptr }
+		{
+			written.store(0, std::memory_order_relaxed);
+			next.store(nullptr, std::memory_order_relaxed);
+		}
+
+		~segment()
+		{
+			free(values);
+		}
+	};
+
+	const std::size_t segment_size;
+	const std::size_t max_segments;
+	const clock_type::duration idle_period;
+
+	// producer side
+	segment * tail;
+	std::size_t write_index;
+	std::atomic<std::size_t> pushed;
+
+	// consumer side
+	segment * head;
+	std::size_t read_index;
+	std::atomic<std::size_t> popped;
+
+	spin_lock pool_guard;
+	segment * pool;
+	std::size_t segments;
+
+	std::atomic<bool> terminated;
+	mutable _Wait data_waiter;
+
+public:
+	segmented_cyclic_buffer(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	// '_max_segments' == 0 lets the buffer grow without bound
+	segmented_cyclic_buffer(const std::size_t & _segment_size, const std::size_t & _max_segments = 0, const clock_type::duration & _idle_period = std::chrono::seconds(1)) :
+		segment_size{ _segment_size },
+		max_segments{ _max_segments },
+		idle_period{ _idle_period }
+	{
+		assert(_segment_size > (std::size_t)1);
+		assert((_max_segments == 0) || (_max_segments > (std::size_t)1));
+
+		head = tail = new segment(segment_size);
+		write_index = read_index = 0;
+		pushed = popped = 0;
+
+		pool = nullptr;
+		segments = 1;
+
+		terminated = false;
+	}
+
+	~segmented_cyclic_buffer()
+	{
+		if (!terminated)
+			terminate();
+
+		for (segment * it = head, * next; it != nullptr; it = next)
+		{
+			next = it->next.load(std::memory_order_relaxed);
+			delete it;
+		}
+
+		for (segment * it = pool, * next; it != nullptr; it = next)
+		{
+			next = it->pooled;
+			delete it;
+		}
+	}
+
+	inline void terminate()
+	{
+		terminated = true;
+		data_waiter.notify();
+	}
+
+	inline bool is_terminated() const
+	{
+		return terminated;
+	}
+
+	// false only when 'max_segments' are all in use
+	inline bool push(const value_type & value)
+	{
+		if (write_index == segment_size)
+		{
+			segment * const fresh{ acquire_() };
+			if (fresh == nullptr)
+				return false;
+
+			tail->next.store(fresh, std::memory_order_release);
+			tail = fresh;
+			write_index = 0;
+		}
+
+		tail->values[write_index] = value;
+		pushed.store(pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		tail->written.store(++write_index, std::memory_order_release);
+
+		data_waiter.notify();
+
+		return true;
+	}
+
+	inline bool try_pop(value_type & value)
+	{
+		if (read_index == head->written.load(std::memory_order_acquire))
+		{
+			if (read_index < segment_size)
+				return false;
+
+			segment * const next{ head->next.load(std::memory_order_acquire) };
+			if (next == nullptr)
+				return false;
+
+			release_(head);
+			head = next;
+			read_index = 0;
+
+			if (head->written.load(std::memory_order_acquire) == 0)
+				return false;
+		}
+
+		value = head->values[read_index++];
+		popped.store(popped.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	// waits for data; false once the buffer is terminated and drained
+	inline bool pop(value_type & value)
+	{
+		while (!try_pop(value))
+		{
+			if (terminated)
+				return try_pop(value);
+
+			wait_for_data();
+		}
+
+		return true;
+	}
+
+	inline void wait_for_data() const
+	{
+		data_waiter.wait([this] { return (get_size() > 0) || terminated; });
+	}
+
+	template<class _Rep, class _Period>
+	inline bool wait_for_data_for(const std::chrono::duration<_Rep, _Period>& rel_time) const
+	{
+		return wait_for_data_until(clock_type::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool wait_for_data_until(const std::chrono::time_point<_Clock, _Duration>& timeout_time) const
+	{
+		return data_waiter.wait_until([this] { return (get_size() > 0) || terminated; }, timeout_time);
+	}
+
+	inline std::size_t get_size() const
+	{
+		std::size_t const consumed{ popped.load(std::memory_order_acquire) };
+
+		return pushed.load(std::memory_order_acquire) - consumed;
+	}
+
+	inline std::size_t get_segment_size() const
+	{
+		return segment_size;
+	}
+
+	// segments currently allocated, linked or pooled
+	inline std::size_t get_segment_count()
+	{
+		std::lock_guard<spin_lock> lock(pool_guard);
+
+		return segments;
+	}
+
+	inline std::size_t get_capacity()
+	{
+		return get_segment_count() * segment_size;
+	}
+
+	// frees pooled segments unused for 'idle_period'; drained segments trigger this too,
+	// a queue that goes quiet needs an occasional call
+	inline void trim()
+	{
+		std::unique_lock<spin_lock> lock(pool_guard);
+
+		delete_(detach_expired_(clock_type::now()), lock);
+	}
+
+	// frees every pooled segment right away
+	inline void shrink()
+	{
+		std::unique_lock<spin_lock> lock(pool_guard);
+
+		segment * const released{ pool };
+		pool = nullptr;
+
+		delete_(released, lock);
+	}
+
+private:
+	inline segment * acquire_()
+	{
+		{
+			std::lock_guard<spin_lock> lock(pool_guard);
+
+			if (pool != nullptr)
+			{
+				segment * const result{ pool };
+				pool = result->pooled;
+
+				result->pooled = nullptr;
+				result->written.store(0, std::memory_order_relaxed);
+				result->next.store(nullptr, std::memory_order_relaxed);
+
+				return result;
+			}
+
+			if ((max_segments != 0) && (segments >= max_segments))
+				return nullptr;
+
+			++segments;
+		}
+
+		return new segment(segment_size);
+	}
+
+	inline void release_(segment * const drained)
+	{
+		clock_type::time_point const now{ clock_type::now() };
+		std::unique_lock<spin_lock> lock(pool_guard);
+
+		drained->released = now;
+		drained->pooled = pool;
+		pool = drained;
+
+		delete_(detach_expired_(now), lock);
+	}
+
+	// the pool is LIFO, so idle segments collect at its end
+	inline segment * detach_expired_(const clock_type::time_point & now)
+	{
+		for (segment ** it = &pool; *it != nullptr; it = &(*it)->pooled)
+		{
+			if (now - (*it)->released >= idle_period)
+			{
+				segment * const result{ *it };
+				*it = nullptr;
+
+				return result;
+			}
+		}
+
+		return nullptr;
+	}
+
+	inline void delete_(segment * released, std::unique_lock<spin_lock> & lock)
+	{
+		for (segment * it = released; it != nullptr; it = it->pooled)
+			--segments;
+
+		lock.unlock();
+
+		for (segment * next; released != nullptr; released = next)
+		{
+			next = released->pooled;
+			delete released;
+		}
+	}
+};
+
+#endif // !_SEGMENTED_CYCLIC_BUFFER_H_
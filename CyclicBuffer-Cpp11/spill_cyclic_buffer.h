@@ -0,0 +1,316 @@
+#ifndef _SPILL_CYCLIC_BUFFER_H_
+#define _SPILL_CYCLIC_BUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <assert.h>
+
+#include "basic_cyclic_buffer.h"
+#include "mapped_file.h"
+#include "spin_lock.h"
+
+// Single producer / single consumer buffer that never blocks and never loses data: once
+// the in-memory ring is full, pushes are appended to memory-mapped segment files
+// ('<path_prefix>.<n>.spill') until the consumer has drained the disk backlog. The
+// consumer always empties the ring (older data) before the disk segments, in order.
+template<typename _Ty, class _Wait = cyclic_policy::park_wait>
+class spill_cyclic_buffer
+{
+	static_assert(std::is_trivially_copyable<_Ty>::value, "Error: 'spill_cyclic_buffer' type must be trivially copyable.");
+	static_assert(!std::is_const<_Ty>::value, "Error: 'spill_cyclic_buffer' type can not be const.");
+	static_assert(!std::is_volatile<_Ty>::value, "Error: 'spill_cyclic_buffer' type can not be volatile.");
+
+public:
+	typedef _Ty value_type;
+	typedef spill_cyclic_buffer<_Ty, _Wait> type;
+	static constexpr bool is_lock_free{ false };
+	static constexpr bool is_recyclable{ false };
+
+private:
+	struct disk_segment
+	{
+		mapped_file file;
+		std::string path;
+		std::size_t written;
+		std::size_t read;
+
+		inline value_type * records() const
+		{
+			return (value_type*)file.data();
+		}
+	};
+
+	basic_cyclic_buffer<value_type, cyclic_policy::spsc, cyclic_policy::fail, cyclic_policy::spin_wait> ring;
+
+	const std::string path_prefix;
+	const std::size_t segment_records;
+	const std::size_t max_recycled;
+
+	spin_lock guard;
+	std::deque<disk_segment*> segments;
+	std::vector<disk_segment*> recycled;
+	std::size_t file_counter;
+
+	std::atomic<bool> spilling;
+	std::atomic<std::size_t> spilled;
+	std::atomic<std::size_t> dropped;
+
+	std::atomic<bool> terminated;
+	mutable _Wait data_waiter;
+
+public:
+	spill_cyclic_buffer(const type &) = delete;
+	type & operator=(const type &) = delete;
+
+	// '_capacity' is the in-memory threshold; each segment file holds '_segment_records' elements
+	spill_cyclic_buffer(const std::size_t & _capacity, const std::string & _path_prefix, const std::size_t & _segment_records = (std::size_t)1 << 16, const std::size_t & _max_recycled = 2) :
+		ring{ _capacity },
+		path_prefix{ _path_prefix },
+		segment_records{ _segment_records },
+		max_recycled{ _max_recycled }
+	{
+		assert(_segment_records > (std::size_t)0);
+
+		file_counter = 0;
+		spilling = false;
+		spilled = 0;
+		dropped = 0;
+		terminated = false;
+	}
+
+	~spill_cyclic_buffer()
+	{
+		if (!terminated)
+			terminate();
+
+		for (disk_segment * it : segments)
+			destroy_(it);
+
+		for (disk_segment * it : recycled)
+			destroy_(it);
+	}
+
+	inline void terminate()
+	{
+		terminated = true;
+		data_waiter.notify();
+	}
+
+	inline bool is_terminated() const
+	{
+		return terminated;
+	}
+
+	// false only when a spill segment could not be created; the element is counted in 'get_dropped'
+	inline bool push(const value_type & value)
+	{
+		if (spilling.load(std::memory_order_relaxed) || !ring.try_push(value))
+		{
+			if (!spill_(value))
+				return false;
+		}
+
+		data_waiter.notify();
+
+		return true;
+	}
+
+	inline bool try_pop(value_type & value)
+	{
+		if (ring.try_pop(value))
+			return true;
+
+		if (spilled.load(std::memory_order_acquire) == 0)
+			return false;
+
+		std::lock_guard<spin_lock> lock(guard);
+
+		if (segments.empty() || (segments.front()->read == segments.front()->written))
+			return false;
+
+		disk_segment * const front{ segments.front() };
+		value = front->records()[front->read++];
+
+		if (front->read == segment_records)
+		{
+			segments.pop_front();
+			recycle_(front);
+		}
+
+		if (spilled.fetch_sub(1, std::memory_order_release) == 1)
+		{
+			// disk backlog drained: producer goes back to the ring
+			while (!segments.empty())
+			{
+				recycle_(segments.front());
+				segments.pop_front();
+			}
+
+			spilling.store(false, std::memory_order_relaxed);
+		}
+
+		return true;
+	}
+
+	// waits for data; false once the buffer is terminated and drained
+	inline bool pop(value_type & value)
+	{
+		while (!try_pop(value))
+		{
+			if (terminated)
+				return try_pop(value);
+
+			wait_for_data();
+		}
+
+		return true;
+	}
+
+	inline void wait_for_data() const
+	{
+		data_waiter.wait([this] { return (get_size() > 0) || terminated; });
+	}
+
+	template<class _Rep, class _Period>
+	inline bool wait_for_data_for(const std::chrono::duration<_Rep, _Period>& rel_time) const
+	{
+		return wait_for_data_until(std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template<class _Clock, class _Duration>
+	inline bool wait_for_data_until(const std::chrono::time_point<_Clock, _Duration>& timeout_time) const
+	{
+		return data_waiter.wait_until([this] { return (get_size() > 0) || terminated; }, timeout_time);
+	}
+
+	inline std::size_t get_capacity() const
+	{
+		return ring.get_capacity();
+	}
+
+	inline std::size_t get_size() const
+	{
+		return ring.get_size() + spilled.load(std::memory_order_acquire);
+	}
+
+	inline std::size_t get_spilled() const
+	{
+		return spilled.load(std::memory_order_relaxed);
+	}
+
+	inline std::size_t get_dropped() const
+	{
+		return dropped.load(std::memory_order_relaxed);
+	}
+
+	inline bool is_spilling() const
+	{
+		return spilling.load(std::memory_order_relaxed);
+	}
+
+private:
+	inline bool spill_(const value_type & value)
+	{
+		std::unique_lock<spin_lock> lock(guard);
+		disk_segment * fresh{ nullptr };
+
+		for (;;)
+		{
+			if (!spilling.load(std::memory_order_relaxed))
+			{
+				if (ring.try_push(value))
+				{
+					if (fresh != nullptr)
+						recycle_(fresh);
+
+					return true;
+				}
+
+				spilling.store(true, std::memory_order_relaxed);
+			}
+
+			if (!segments.empty() && (segments.back()->written < segment_records))
+				break;
+
+			if ((fresh == nullptr) && !recycled.empty())
+			{
+				fresh = recycled.back();
+				recycled.pop_back();
+			}
+
+			if (fresh != nullptr)
+			{
+				fresh->written = fresh->read = 0;
+				segments.push_back(fresh);
+				fresh = nullptr;
+				break;
+			}
+
+			// file creation is slow, keep the consumer going meanwhile
+			std::string const path{ path_prefix + "." + std::to_string(file_counter++) + ".spill" };
+			lock.unlock();
+			fresh = create_(path);
+			lock.lock();
+
+			if (fresh == nullptr)
+			{
+				// with nothing on disk order does not depend on spilling, so the producer goes
+				// back to the ring rather than retrying the disk on every push
+				if (spilled.load(std::memory_order_relaxed) == 0)
+				{
+					spilling.store(false, std::memory_order_relaxed);
+
+					if (ring.try_push(value))
+						return true;
+				}
+
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		disk_segment * const back{ segments.back() };
+		back->records()[back->written++] = value;
+		spilled.fetch_add(1, std::memory_order_release);
+
+		return true;
+	}
+
+	inline disk_segment * create_(const std::string & path)
+	{
+		disk_segment * const result{ new disk_segment };
+		result->path = path;
+		result->written = result->read = 0;
+
+		if (!result->file.create(path, segment_records * sizeof(value_type)))
+		{
+			delete result;
+			return nullptr;
+		}
+
+		return result;
+	}
+
+	inline void recycle_(disk_segment * const segment)
+	{
+		if (recycled.size() < max_recycled)
+			recycled.push_back(segment);
+		else
+			destroy_(segment);
+	}
+
+	static inline void destroy_(disk_segment * const segment)
+	{
+		segment->file.close();
+		mapped_file::remove(segment->path);
+
+		delete segment;
+	}
+};
+
+#endif // !_SPILL_CYCLIC_BUFFER_H_
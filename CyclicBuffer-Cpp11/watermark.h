@@ -0,0 +1,135 @@
+#ifndef _WATERMARK_H_
+#define _WATERMARK_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <assert.h>
+
+#include "spin_lock.h"
+
+// High/low occupancy watermarks with hysteresis: the state flips to 'high' once the size
+// reaches 'high' and back only when it falls to 'low'. Owners report every size change;
+// a change that crosses nothing costs one comparison.
+// The callback runs with no lock held, on whichever thread finds a flip not yet reported;
+// it always gets the latest state, each change once, so it may push to or pop from the
+// buffer itself.
+class watermark
+{
+public:
+	typedef std::function<void(bool)> callback_type;
+
+private:
+	std::size_t high;
+	std::size_t low;
+	callback_type callback;
+
+	std::atomic<bool> pressed;
+	spin_lock guard;
+
+	std::atomic<bool> reported; // last state handed to 'callback'
+	std::atomic<bool> reporting;
+
+public:
+	watermark(const watermark&) = delete;
+	watermark& operator=(const watermark&) = delete;
+
+	watermark() :
+		high{ (std::size_t)-1 },
+		low{ 0 }
+	{
+		pressed = false;
+		reported = false;
+		reporting = false;
+	}
+
+	// not thread safe; configure before the owner is shared
+	inline void set(const std::size_t & _high, const std::size_t & _low, callback_type _callback = nullptr)
+	{
+		assert(_low < _high /* Error: 'watermark' low mark must be below the high mark. */);
+
+		high = _high;
+		low = _low;
+		callback = std::move(_callback);
+		pressed = false;
+		reported = false;
+	}
+
+	inline void reset()
+	{
+		high = (std::size_t)-1;
+		low = 0;
+		callback = nullptr;
+		pressed = false;
+		reported = false;
+	}
+
+	inline bool is_enabled() const
+	{
+		return (high != (std::size_t)-1);
+	}
+
+	inline bool is_high() const
+	{
+		return pressed.load(std::memory_order_relaxed);
+	}
+
+	// '_reload' re-reads the current size, so concurrent crossings settle on the latest one
+	template<class _Reload>
+	inline void on_add(const std::size_t & size, _Reload && _reload)
+	{
+		if ((size >= high) && !pressed.load(std::memory_order_relaxed))
+			flip_(true, _reload);
+	}
+
+	template<class _Reload>
+	inline void on_sub(const std::size_t & size, _Reload && _reload)
+	{
+		if ((size <= low) && pressed.load(std::memory_order_relaxed))
+			flip_(false, _reload);
+	}
+
+private:
+	template<class _Reload>
+	inline void flip_(const bool state, _Reload & _reload)
+	{
+		{
+			std::lock_guard<spin_lock> lock(guard);
+
+			if (pressed.load(std::memory_order_relaxed) == state)
+				return;
+
+			std::size_t const size{ _reload() };
+			if (state ? (size < high) : (size > low))
+				return;
+
+			pressed.store(state);
+		}
+
+		if (callback)
+			report_();
+	}
+
+	// one thread reports at a time; a flip made meanwhile (also from inside the callback)
+	// is picked up by the reporting thread before it leaves
+	inline void report_()
+	{
+		while (!reporting.exchange(true))
+		{
+			bool state;
+			while ((state = pressed.load()) != reported.load())
+			{
+				reported.store(state);
+				callback(state);
+			}
+
+			reporting.store(false);
+
+			if (pressed.load() == reported.load())
+				return;
+		}
+	}
+};
+
+#endif // !_WATERMARK_H_